@@ -0,0 +1,91 @@
+#ifndef LIME_BENCH_CORPUS_H
+#define LIME_BENCH_CORPUS_H
+
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/*
+* Documents shaped like the usual json corpora, generated so the benchmarks
+* run without downloading anything. The real files can be loaded instead.
+*/
+namespace corpus {
+  /* like twitter.json, objects with long strings and nested users */
+  inline std::string twitter(size_t records = 3000) {
+    std::string res { "[" };
+    for (size_t i = 0; i < records; i++) {
+      if (i > 0) {
+        res += ",\n";
+      }
+
+      res += std::format(
+        "{{\"id\": {}, \"created_at\": \"Mon Sep 24 03:35:21 +0000 2012\", "
+        "\"text\": \"@lime meeting today went well, see you all at the office tomorrow #{}\", "
+        "\"user\": {{\"id\": {}, \"name\": \"user {}\", \"screen_name\": \"u{}\", "
+        "\"followers_count\": {}, \"verified\": {}}}, \"retweet_count\": {}, "
+        "\"coordinates\": [{}.25, -{}.5], \"hashtags\": [\"lime\", \"json\", \"bench\"], "
+        "\"favorited\": false}}",
+        505874924095815681 + i, i, 1186275104 + i, i, i,
+        i * 7 % 1000, i % 2 ? "true" : "false", i % 50,
+        i % 90, i % 180
+      );
+    }
+    res += "]";
+    return res;
+  }
+
+  /* like canada.json, a geojson polygon of mostly floats with a few integers and exponents */
+  inline std::string canada(size_t points = 40000) {
+    std::string res { "{\"type\": \"Polygon\", \"coordinates\": [" };
+    for (size_t i = 0; i < points; i++) {
+      if (i > 0) {
+        res += ",\n";
+      }
+
+      res += std::format(
+        "[{:.14f}, {:.14f}, {}, {:e}]",
+        -65.613616999999977 + i * 1e-5, 43.420273000000009 - i * 3e-6,
+        i % 1000, 1.5e-3 * (i + 1)
+      );
+    }
+    res += "]}";
+    return res;
+  }
+
+  /*
+  * like citm_catalog.json, keyed objects with small integers and short arrays,
+  * json::Node has no null so the nulls of the original are empty strings
+  */
+  inline std::string citm(size_t events = 2000) {
+    std::string res { "{\"events\": {" };
+    for (size_t i = 0; i < events; i++) {
+      if (i > 0) {
+        res += ",\n";
+      }
+
+      res += std::format(
+        "\"{}\": {{\"description\": \"\", \"id\": {}, \"logo\": {}, \"name\": \"Event {}\", "
+        "\"subTopicIds\": [337184, {}, 337185], \"subjectCode\": \"\", \"subtitle\": \"\", "
+        "\"topicIds\": [324846253, {}], \"prices\": [{{\"amount\": {}, \"audienceSubCategoryId\": 337100890, "
+        "\"seatCategoryId\": {}}}, {{\"amount\": {}, \"audienceSubCategoryId\": 337100890, \"seatCategoryId\": {}}}]}}",
+        138586341 + i, 138586341 + i,
+        i % 3 ? "\"\"" : "\"/images/UE0AAAAACEKo6QAAAAZDSVRN\"",
+        i, 337184262 + i % 40, 107888604 + i % 17,
+        90250 + i % 7 * 1000, 338937295 + i % 5, 66500 + i % 11 * 500, 338937296 + i % 5
+      );
+    }
+    res += "}, \"areaNames\": {\"205705993\": \"Arrière-scène central\", \"205705994\": \"1er balcon central\"}}";
+    return res;
+  }
+
+  /* returns an empty string when the file can not be read */
+  inline std::string load(const std::string& path) {
+    std::ifstream file { path };
+    std::stringstream buffer {};
+    buffer << file.rdbuf();
+    return buffer.str();
+  }
+} // corpus
+
+#endif // LIME_BENCH_CORPUS_H
@@ -0,0 +1,163 @@
+#ifndef LIME_BENCH_BASELINE_H
+#define LIME_BENCH_BASELINE_H
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+
+/*
+* The byte at a time scanner json::Scanner replaced, kept as the baseline
+* json::StructuralIndex is measured against. The loop is the old one, it
+* only also steps over exponents and escaped quotes so it gets through the
+* whole corpus instead of stopping at the first one.
+*/
+namespace baseline {
+  enum class Token {
+    EndOfFile,
+    Invalid,
+    Int,
+    Float,
+    Bool,
+    String,
+    Structural,
+  };
+
+  class Scanner {
+  public:
+    explicit Scanner(std::string_view data)
+    : m_data(data) {}
+
+    Token token() {
+      if (skip_whitespaces()) {
+        return Token::EndOfFile;
+      }
+
+      const size_t begin { m_cursor };
+      switch (curr_char()) {
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+        forward();
+        return Token::Structural;
+      }
+
+      if (std::isdigit(curr_char()) || (curr_char() == '-' && std::isdigit(peek_char()))) {
+        bool is_float { false };
+        if (curr_char() == '-') {
+          forward();
+        }
+
+        while (!is_end() && (std::isdigit(curr_char()) || curr_char() == '.' || exponent())) {
+          is_float |= !std::isdigit(curr_char());
+          forward();
+        }
+
+        const std::string number { m_data.substr(begin, m_cursor - begin) };
+        if (is_float) {
+          m_value = std::stod(number);
+          return Token::Float;
+        }
+
+        m_value = std::stoll(number);
+        return Token::Int;
+      }
+
+      if (std::isalpha(curr_char())) {
+        while (!is_end() && std::isalpha(curr_char())) {
+          forward();
+        }
+
+        const std::string_view ident { m_data.substr(begin, m_cursor - begin) };
+        if (ident != "true" && ident != "false") {
+          return Token::Invalid;
+        }
+
+        m_value = ident == "true";
+        return Token::Bool;
+      }
+
+      if (curr_char() == '"') {
+        forward();
+        while (!is_end() && curr_char() != '"') {
+          if (curr_char() == '\n') {
+            return Token::Invalid;
+          }
+          if (curr_char() == '\\') {
+            forward();
+          }
+          forward();
+        }
+
+        m_value = std::string { m_data.substr(begin + 1, m_cursor - begin - 1) };
+        forward();
+        return Token::String;
+      }
+
+      return Token::Invalid;
+    }
+
+  private:
+    [[nodiscard]]
+    bool is_end() const {
+      return m_cursor >= m_data.length();
+    }
+
+    /* the old scanner kept a row and line start for its errors */
+    void forward() {
+      if (!is_end() && m_cursor++ && !is_end() && curr_char() == '\n') {
+        m_row++;
+        m_lnbeg = m_cursor + 1;
+      }
+    }
+
+    [[nodiscard]]
+    bool skip_whitespaces() {
+      while (!is_end() && std::isspace(curr_char())) {
+        forward();
+      }
+      return is_end();
+    }
+
+    [[nodiscard]]
+    char curr_char() const {
+      return is_end() ? 0 : m_data[m_cursor];
+    }
+
+    [[nodiscard]]
+    char peek_char() const {
+      return m_cursor + 1 >= m_data.length() ? 0 : m_data[m_cursor + 1];
+    }
+
+    [[nodiscard]]
+    bool exponent() const {
+      const char c { curr_char() };
+      return c == 'e' || c == 'E' || ((c == '+' || c == '-') && (m_data[m_cursor - 1] | 0x20) == 'e');
+    }
+
+    std::variant<int64_t, double, bool, std::string> m_value;
+    std::string_view m_data;
+    size_t           m_cursor = 0;
+    size_t           m_row = 0;
+    size_t           m_lnbeg = 0;
+  };
+
+  /* tokens of a whole document, 0 when it stops early */
+  [[nodiscard]]
+  inline size_t tokens(std::string_view data) {
+    Scanner scanner { data };
+    size_t count { 0 };
+    for (Token token; (token = scanner.token()) != Token::EndOfFile; count++) {
+      if (token == Token::Invalid) {
+        return 0;
+      }
+    }
+    return count;
+  }
+} // baseline
+
+#endif // LIME_BENCH_BASELINE_H
@@ -0,0 +1,156 @@
+#include <chrono>
+#include <print>
+#include <lime.h>
+#include <lime/json/index.h>
+#include <lime/json/parser.h>
+
+#include "../corpus.h"
+#include "baseline.h"
+
+namespace json = lime::json;
+
+static void run(const std::string& name, const std::string& data);
+[[nodiscard]]
+static size_t tokens(const std::string& data, const json::Isa& isa);
+template <typename F>
+static double measure(const std::string& data, F func);
+
+/*
+* usage: json_scan [file.json]
+* without a file documents shaped like twitter.json, canada.json
+* and citm_catalog.json are generated, see bench/corpus.h.
+*/
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    const std::string data { corpus::load(argv[1]) };
+    if (data.empty()) {
+      std::println(stderr, "nothing to scan");
+      return 1;
+    }
+
+    run(argv[1], data);
+    return 0;
+  }
+
+  run("twitter", corpus::twitter());
+  std::println("");
+  run("canada", corpus::canada());
+  std::println("");
+  run("citm", corpus::citm());
+}
+
+void run(const std::string& name, const std::string& data) {
+  std::println("{}: {} bytes, best isa: {}", name, data.size(), json::to_string(json::best_isa()));
+
+  for (const auto isa: { json::Isa::Scalar, json::Isa::SSE42, json::Isa::AVX2 }) {
+    if (!json::supported(isa)) {
+      continue;
+    }
+
+    const double speed {
+      measure(data, [&data, isa]() {
+        return json::StructuralIndex { data, isa }.size();
+      })
+    };
+    std::println("index {:<6} {:>8.1f} MB/s", json::to_string(isa), speed);
+  }
+
+  /* tokenizing, the old byte at a time scanner against the one walking the index */
+  if (baseline::tokens(data) != tokens(data, json::best_isa())) {
+    std::println(stderr, "the scanners disagree on the number of tokens");
+  }
+
+  const double old_scan {
+    measure(data, [&data]() {
+      return baseline::tokens(data);
+    })
+  };
+  std::println("scan  {:<6} {:>8.1f} MB/s", "bytes", old_scan);
+
+  for (const auto isa: { json::Isa::Scalar, json::Isa::SSE42, json::Isa::AVX2 }) {
+    if (!json::supported(isa)) {
+      continue;
+    }
+
+    const double speed {
+      measure(data, [&data, isa]() {
+        return tokens(data, isa);
+      })
+    };
+    std::println("scan  {:<6} {:>8.1f} MB/s", json::to_string(isa), speed);
+  }
+
+  const double decode {
+    measure(data, [&data]() {
+      const auto node { json::decode(data) };
+      return node ? 1 : 0;
+    })
+  };
+  std::println("decode   {:>8.1f} MB/s", decode);
+
+  const double document {
+    measure(data, [&data]() {
+      const auto doc { json::Document::parse(data) };
+      return doc ? 1 : 0;
+    })
+  };
+  std::println("document {:>8.1f} MB/s", document);
+
+  /* a pointer that never resolves makes extract walk the whole document */
+  const double extract {
+    measure(data, [&data]() {
+      const auto values { json::extract(data, { "/0/id", "/missing" }) };
+      return values ? 1 : 0;
+    })
+  };
+  std::println("extract  {:>8.1f} MB/s", extract);
+
+  const auto node { json::decode(data) };
+  std::string buffer {};
+  const double encode {
+    measure(data, [&node, &buffer]() {
+      buffer.clear();
+      json::encode(*node, buffer);
+      return buffer.size();
+    })
+  };
+  std::println("encode   {:>8.1f} MB/s", encode);
+}
+
+/* tokens of a whole document, 0 when it is invalid */
+size_t tokens(const std::string& data, const json::Isa& isa) {
+  json::Scanner scanner { data, isa };
+  size_t count { 0 };
+  while (true) {
+    const auto token { scanner.token() };
+    if (!token || *token == json::Token::Invalid) {
+      return 0;
+    }
+    if (*token == json::Token::EndOfFile) {
+      return count;
+    }
+    count++;
+  }
+}
+
+/* repeats func for about a second and returns the throughput */
+template <typename F>
+double measure(const std::string& data, F func) {
+  using Clock = std::chrono::steady_clock;
+
+  size_t sink { 0 }, runs { 0 };
+  const auto begin { Clock::now() };
+  auto now { begin };
+  while (now - begin < std::chrono::seconds { 1 }) {
+    sink += func();
+    runs++;
+    now = Clock::now();
+  }
+
+  if (sink == 0) {
+    std::println(stderr, "invalid document");
+  }
+
+  const double seconds { std::chrono::duration<double>(now - begin).count() };
+  return data.size() * runs / seconds / 1e6;
+}
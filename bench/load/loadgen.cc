@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <charconv>
+#include <deque>
+#include <format>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "loadgen.h"
+
+namespace load {
+  using Clock = std::chrono::steady_clock;
+
+  namespace response {
+    /* lime ends header lines with a bare \n, so both line endings are accepted */
+    [[nodiscard]]
+    static size_t head_end(const std::string& data) {
+      for (size_t i = 0; i + 1 < data.size(); i++) {
+        if (data[i] != '\n') {
+          continue;
+        }
+        if (data[i + 1] == '\n') {
+          return i + 2;
+        }
+        if (data[i + 1] == '\r' && i + 2 < data.size() && data[i + 2] == '\n') {
+          return i + 3;
+        }
+      }
+      return std::string::npos;
+    }
+
+    /* value of a header in the head, names compared without case */
+    [[nodiscard]]
+    static std::string_view header(std::string_view head, std::string_view name) {
+      size_t line { head.find('\n') };
+      while (line != std::string_view::npos && line + 1 < head.size()) {
+        const std::string_view rest { head.substr(line + 1) };
+        line = head.find('\n', line + 1);
+
+        if (rest.size() <= name.size() || rest[name.size()] != ':') {
+          continue;
+        }
+
+        const bool same {
+          std::equal(name.begin(), name.end(), rest.begin(), [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+          })
+        };
+        if (!same) {
+          continue;
+        }
+
+        std::string_view value { rest.substr(name.size() + 1) };
+        value = value.substr(0, value.find('\n'));
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+          value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == '\r' || value.back() == ' ')) {
+          value.remove_suffix(1);
+        }
+        return value;
+      }
+      return {};
+    }
+  } // response
+
+  /* a connection with at most one request in flight */
+  struct Client {
+    int               fd = -1;
+    bool              busy = false;
+    bool              connecting = false;
+    /* close once the response is read */
+    bool              closing = false;
+    size_t            sent = 0;
+    std::string       in {};
+    Clock::time_point start {};
+  };
+
+  /* the share of the load of one thread */
+  class Worker {
+  public:
+    Worker(const Target& target, const Options& options, size_t connections, double rate, lime::metrics::Histogram& latency)
+    : m_target(target), m_options(options), m_rate(rate), m_latency(latency), m_clients(connections) {
+      m_addr.sin_family = AF_INET;
+      m_addr.sin_port = htons(target.port);
+      inet_pton(AF_INET, target.host.c_str(), &m_addr.sin_addr);
+    }
+
+    ~Worker() {
+      for (auto& client: m_clients) {
+        close_client(client);
+      }
+      if (m_epoll >= 0) {
+        close(m_epoll);
+      }
+    }
+
+    void run(Clock::time_point begin, Clock::time_point end) {
+      m_epoll = epoll_create1(0);
+      if (m_epoll < 0) {
+        m_errors++;
+        return;
+      }
+
+      for (auto& client: m_clients) {
+        m_idle.push_back(&client);
+      }
+
+      const auto interval {
+        m_rate > 0
+          ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double> { 1.0 / m_rate })
+          : Clock::duration::zero()
+      };
+      Clock::time_point due { begin };
+      std::deque<Clock::time_point> pending {};
+      epoll_event events[64];
+
+      for (auto now { Clock::now() }; now < end; now = Clock::now()) {
+        if (m_rate > 0) {
+          for (; due <= now; due += interval) {
+            pending.push_back(due);
+          }
+        }
+
+        /* bounded, a client failing to connect is back in m_idle right away */
+        for (size_t ready = m_idle.size(); ready > 0 && (m_rate == 0 || !pending.empty()); ready--) {
+          Client* client { m_idle.back() };
+          m_idle.pop_back();
+
+          Clock::time_point start { now };
+          if (m_rate > 0) {
+            start = pending.front();
+            pending.pop_front();
+          }
+          send_request(*client, start);
+        }
+
+        /* sleep until the next request is due, a spinning client would take cpu from the server */
+        auto timeout { std::chrono::nanoseconds { std::chrono::milliseconds { 10 } } };
+        if (m_rate > 0) {
+          timeout = std::clamp(std::chrono::duration_cast<std::chrono::nanoseconds>(due - now), std::chrono::nanoseconds { 0 }, timeout);
+        }
+
+        const int n { wait(events, std::size(events), timeout) };
+        for (int i = 0; i < n; i++) {
+          handle(*static_cast<Client*>(events[i].data.ptr), events[i].events);
+        }
+      }
+    }
+
+    uint64_t requests() const { return m_requests; }
+    uint64_t errors() const { return m_errors; }
+    uint64_t unexpected() const { return m_unexpected; }
+
+  private:
+    /* epoll_pwait2 takes a timeout in nanoseconds, older kernels round up to milliseconds */
+    int wait(epoll_event* events, int size, std::chrono::nanoseconds timeout) {
+    #if defined(__GLIBC__) && __GLIBC_PREREQ(2, 35)
+      const timespec spec {
+        static_cast<time_t>(timeout.count() / 1'000'000'000),
+        static_cast<long>(timeout.count() % 1'000'000'000),
+      };
+
+      const int n { epoll_pwait2(m_epoll, events, size, &spec, nullptr) };
+      if (n >= 0 || errno != ENOSYS) {
+        return n;
+      }
+    #endif
+      return epoll_wait(m_epoll, events, size, static_cast<int>((timeout.count() + 999'999) / 1'000'000));
+    }
+
+    void send_request(Client& client, Clock::time_point start) {
+      client.busy = true;
+      client.sent = 0;
+      client.in.clear();
+      client.start = start;
+
+      if (client.fd < 0 && !open_client(client)) {
+        fail(client);
+        return;
+      }
+
+      if (!client.connecting) {
+        write_request(client);
+      }
+    }
+
+    bool open_client(Client& client) {
+      client.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+      if (client.fd < 0) {
+        return false;
+      }
+
+      const int one { 1 };
+      setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      if (m_options.mode == Mode::Close) {
+        /* reset instead of lingering in TIME_WAIT, which would run out of ports */
+        const linger reset { 1, 0 };
+        setsockopt(client.fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+      }
+
+      if (connect(client.fd, reinterpret_cast<const sockaddr*>(&m_addr), sizeof(m_addr)) < 0) {
+        if (errno != EINPROGRESS) {
+          return false;
+        }
+        client.connecting = true;
+      }
+
+      epoll_event event {};
+      event.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLRDHUP;
+      event.data.ptr = &client;
+      return epoll_ctl(m_epoll, EPOLL_CTL_ADD, client.fd, &event) == 0;
+    }
+
+    void close_client(Client& client) {
+      if (client.fd >= 0) {
+        close(client.fd);
+      }
+      client.fd = -1;
+      client.connecting = false;
+      client.closing = false;
+    }
+
+    void handle(Client& client, uint32_t events) {
+      if (!client.busy) {
+        /* the server closed an idle keep-alive connection */
+        if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+          close_client(client);
+        }
+        return;
+      }
+
+      if (client.connecting) {
+        int error { 0 };
+        socklen_t size { sizeof(error) };
+        getsockopt(client.fd, SOL_SOCKET, SO_ERROR, &error, &size);
+        if (error != 0 || (events & EPOLLERR)) {
+          fail(client);
+          return;
+        }
+        if (!(events & EPOLLOUT)) {
+          return;
+        }
+        client.connecting = false;
+      }
+
+      if (client.sent < m_target.request.size() && !write_request(client)) {
+        return;
+      }
+
+      if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        read_response(client);
+      }
+    }
+
+    /* false once the client failed */
+    bool write_request(Client& client) {
+      while (client.sent < m_target.request.size()) {
+        const ssize_t n { send(client.fd, m_target.request.data() + client.sent, m_target.request.size() - client.sent, MSG_NOSIGNAL) };
+        if (n < 0) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+          }
+          fail(client);
+          return false;
+        }
+        client.sent += static_cast<size_t>(n);
+      }
+      return true;
+    }
+
+    void read_response(Client& client) {
+      char buffer[16 * 1024];
+      while (true) {
+        const ssize_t n { recv(client.fd, buffer, sizeof(buffer), 0) };
+        if (n > 0) {
+          client.in.append(buffer, static_cast<size_t>(n));
+          if (complete(client)) {
+            return;
+          }
+          continue;
+        }
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          return;
+        }
+
+        /* closed by the server, a response without length ends here */
+        if (n == 0 && client.closing) {
+          finish(client);
+          return;
+        }
+        fail(client);
+        return;
+      }
+    }
+
+    /* true once the response was read and the client is free again */
+    bool complete(Client& client) {
+      const size_t end { response::head_end(client.in) };
+      if (end == std::string::npos) {
+        return false;
+      }
+
+      const std::string_view head { std::string_view { client.in }.substr(0, end) };
+      const std::string_view connection { response::header(head, "Connection") };
+      client.closing = m_options.mode == Mode::Close || connection == "close" || connection == "Close";
+
+      const std::string_view length { response::header(head, "Content-Length") };
+      if (length.empty()) {
+        if (client.closing) {
+          return false;
+        }
+        finish(client);
+        return true;
+      }
+
+      size_t body { 0 };
+      std::from_chars(length.data(), length.data() + length.size(), body);
+      if (client.in.size() < end + body) {
+        return false;
+      }
+
+      finish(client);
+      return true;
+    }
+
+    void finish(Client& client) {
+      m_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - client.start));
+      m_requests++;
+
+      /* "HTTP/1.1 200 ..." */
+      if (client.in.size() < 10 || client.in[9] != '2') {
+        m_unexpected++;
+      }
+
+      if (client.closing) {
+        close_client(client);
+      }
+      release(client);
+    }
+
+    void fail(Client& client) {
+      m_errors++;
+      close_client(client);
+      release(client);
+    }
+
+    void release(Client& client) {
+      client.busy = false;
+      m_idle.push_back(&client);
+    }
+
+    const Target&             m_target;
+    const Options&            m_options;
+    double                    m_rate;
+    lime::metrics::Histogram& m_latency;
+    std::vector<Client>       m_clients;
+    std::vector<Client*>      m_idle {};
+    sockaddr_in               m_addr {};
+    int                       m_epoll = -1;
+    uint64_t                  m_requests = 0;
+    uint64_t                  m_errors = 0;
+    uint64_t                  m_unexpected = 0;
+  };
+
+  double Result::rps() const {
+    const double seconds { std::chrono::duration<double>(elapsed).count() };
+    return seconds > 0 ? static_cast<double>(requests) / seconds : 0;
+  }
+
+  std::string request(const std::string& method, const std::string& host, const std::string& path, const std::string& body, const Mode& mode) {
+    std::string res {
+      std::format(
+        "{} {} HTTP/1.1\r\nHost: {}\r\nUser-Agent: lime-load\r\nConnection: {}\r\n",
+        method, path, host, mode == Mode::Close ? "close" : "keep-alive"
+      )
+    };
+
+    if (!body.empty()) {
+      res += std::format("Content-Type: application/json\r\nContent-Length: {}\r\n", body.size());
+    }
+    res += "\r\n";
+    res += body;
+    return res;
+  }
+
+  Result run(const Target& target, const Options& options) {
+    const size_t threads { std::max<size_t>(1, std::min(options.threads, options.connections)) };
+    const auto latency { std::make_unique<lime::metrics::Histogram>() };
+
+    std::vector<std::unique_ptr<Worker>> workers {};
+    for (size_t i = 0; i < threads; i++) {
+      const size_t connections { options.connections / threads + (i < options.connections % threads ? 1 : 0) };
+      workers.push_back(std::make_unique<Worker>(target, options, connections, options.rate / static_cast<double>(threads), *latency));
+    }
+
+    const auto begin { Clock::now() };
+    const auto end { begin + options.duration };
+    {
+      std::vector<std::jthread> running {};
+      for (auto& worker: workers) {
+        running.emplace_back([&worker, begin, end]() {
+          worker->run(begin, end);
+        });
+      }
+    }
+
+    Result res {};
+    res.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin);
+    for (const auto& worker: workers) {
+      res.requests += worker->requests();
+      res.errors += worker->errors();
+      res.unexpected += worker->unexpected();
+    }
+    res.latency = latency->snapshot();
+    return res;
+  }
+} // load
@@ -0,0 +1,81 @@
+#ifndef LIME_BENCH_LOADGEN_H
+#define LIME_BENCH_LOADGEN_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <lime/metrics/metrics.h>
+
+/*
+* Http load generator for loopback benchmarks. Every thread drives its
+* connections through an epoll loop, a connection has one request in
+* flight at a time.
+*/
+namespace load {
+  struct Target {
+    /* ipv4 address */
+    std::string host = "127.0.0.1";
+    uint16_t    port = 8080;
+    /* raw request sent as is, see request() */
+    std::string request;
+  };
+
+  enum class Mode {
+    /* requests reuse their connection */
+    KeepAlive,
+    /* every request connects, latency includes the handshake */
+    Close,
+  };
+
+  struct Options {
+    size_t                    threads = 1;
+    /* connections over all threads, the most requests in flight */
+    size_t                    connections = 16;
+    std::chrono::milliseconds duration { 2000 };
+    Mode                      mode = Mode::KeepAlive;
+    /*
+    * requests per second over all threads. 0 sends the next request as soon
+    * as a response arrives, otherwise requests are due at a constant rate
+    * and their latency counts from when they were due, so time spent waiting
+    * for a free connection is not omitted.
+    */
+    double                    rate = 0;
+  };
+
+  struct Result {
+    uint64_t                               requests = 0;
+    /* failed to connect, send or read a complete response */
+    uint64_t                               errors = 0;
+    /* complete responses with a status outside 2xx */
+    uint64_t                               unexpected = 0;
+    std::chrono::nanoseconds               elapsed { 0 };
+    /* nanoseconds, quantiles are bucket upper bounds and at most 12.5% high */
+    lime::metrics::Histogram::Snapshot     latency {};
+
+    [[nodiscard]]
+    double rps() const;
+  };
+
+  /*
+  * @brief Build a request.
+  * @param method Method like "GET".
+  * @param host Value of the Host header.
+  * @param path Path with parameters.
+  * @param body Body, sent with Content-Length when not empty.
+  * @param mode Connection header to send.
+  * @return Raw request.
+  */
+  [[nodiscard]]
+  std::string request(const std::string& method, const std::string& host, const std::string& path, const std::string& body, const Mode& mode);
+
+  /*
+  * @brief Send requests to a target for the duration of the options.
+  * @param target Target.
+  * @param options Options.
+  * @return Requests completed, errors and latencies.
+  */
+  [[nodiscard]]
+  Result run(const Target& target, const Options& options);
+} // load
+
+#endif // LIME_BENCH_LOADGEN_H
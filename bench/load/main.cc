@@ -0,0 +1,276 @@
+#include <charconv>
+#include <format>
+#include <functional>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+#include <lime.h>
+#include <lime/json/escape.h>
+
+#include "loadgen.h"
+
+namespace http = lime::http;
+namespace json = lime::json;
+
+struct Options {
+  /* target like http://127.0.0.1:8080/path, the scenarios run when empty */
+  std::string   url {};
+  std::string   method { "GET" };
+  std::string   body {};
+  bool          json = false;
+  load::Options load {};
+};
+
+/* a server set up like one of the examples and the request sent to it */
+struct Scenario {
+  std::string                         name;
+  std::function<void(http::Router&)>  routes;
+  std::string                         method;
+  std::string                         path;
+  std::string                         body;
+};
+
+static Options s_options {};
+static std::vector<std::pair<std::string, load::Result>> s_results {};
+
+static bool parse_options(int argc, char** argv);
+static bool parse_url(const std::string& url, load::Target& target, std::string& path);
+static load::Result measure(const std::string& name, const load::Target& target, const std::string& path, const load::Options& options);
+static int scenarios();
+static void report();
+
+/*
+* usage: load [--url http://host:port/path] [--method GET] [--body text]
+*             [--threads n] [--connections n] [--duration ms] [--rate rps] [--close] [--json]
+* without --url servers set up like the examples are started in this
+* process and each one is measured with keep-alive connections, with a
+* connection per request and at a constant rate of half the keep-alive
+* throughput.
+*/
+int main(int argc, char** argv) {
+  if (!parse_options(argc, argv)) {
+    std::println(stderr, "usage: {} [--url http://host:port/path] [--method GET] [--body text] "
+      "[--threads n] [--connections n] [--duration ms] [--rate rps] [--close] [--json]", argv[0]);
+    return 1;
+  }
+
+  lime::logging::level = lime::LogLevel::None;
+
+  if (s_options.url.empty()) {
+    const int res { scenarios() };
+    report();
+    return res;
+  }
+
+  load::Target target {};
+  std::string path {};
+  if (!parse_url(s_options.url, target, path)) {
+    std::println(stderr, "invalid url: {}", s_options.url);
+    return 1;
+  }
+
+  measure(s_options.url, target, path, s_options.load);
+  report();
+}
+
+int scenarios() {
+  const std::vector<Scenario> list {
+    {
+      "hello_world",
+      [](http::Router& router) {
+        router.add("/", http::Method::Get, [](const http::Request&) {
+          return http::Response("Hello, World!");
+        });
+      },
+      "GET", "/", "",
+    },
+    {
+      "http_basics",
+      [](http::Router& router) {
+        router.add_regex("/user/.+$", http::Method::Get, [](const http::Request& req) {
+          return http::Response(std::format("welcome back {}", req.segments().back()));
+        });
+      },
+      "GET", "/user/lime", "",
+    },
+    {
+      "json_with_server",
+      [](http::Router& router) {
+        router.add("/user", http::Method::Get, [](const http::Request& req) {
+          const auto decoded { json::decode(req.body) };
+          if (!decoded || decoded->type() != json::NodeType::Object) {
+            return http::Response(http::StatusCode::BadRequest);
+          }
+
+          const auto& obj { decoded->get<json::Object>() };
+          if (!obj.contains("name") || obj.at("name").type() != json::NodeType::String) {
+            return http::Response(http::StatusCode::BadRequest);
+          }
+
+          const json::Node node = json::Object {
+            { "user", obj.at("name").get<std::string>() },
+            { "message", "welcome" },
+          };
+
+          http::Response res(json::encode(node));
+          res.append_header("Content-Type", "application/json");
+          return res;
+        });
+      },
+      "GET", "/user", "{\"name\": \"lime\"}",
+    },
+  };
+
+  for (const auto& scenario: list) {
+    http::Router router {};
+    scenario.routes(router);
+
+    http::Server server { router };
+    if (server.addrs("127.0.0.1").port(0).start() < 0) {
+      std::println(stderr, "{}: failed to start the server", scenario.name);
+      return 1;
+    }
+
+    s_options.method = scenario.method;
+    s_options.body = scenario.body;
+
+    load::Target target {};
+    target.port = server.port();
+
+    load::Options options { s_options.load };
+    options.rate = 0;
+    options.mode = load::Mode::KeepAlive;
+    const load::Result keep_alive { measure(scenario.name + "/keep_alive", target, scenario.path, options) };
+
+    options.mode = load::Mode::Close;
+    measure(scenario.name + "/close", target, scenario.path, options);
+
+    /* below saturation, where the latency is not dominated by queueing */
+    options.mode = load::Mode::KeepAlive;
+    options.rate = s_options.load.rate > 0 ? s_options.load.rate : keep_alive.rps() / 2;
+    if (options.rate > 0) {
+      measure(std::format("{}/rate_{:.0f}", scenario.name, options.rate), target, scenario.path, options);
+    }
+
+    server.stop();
+  }
+
+  return 0;
+}
+
+load::Result measure(const std::string& name, const load::Target& base, const std::string& path, const load::Options& options) {
+  load::Target target { base };
+  target.request = load::request(s_options.method, std::format("{}:{}", target.host, target.port), path, s_options.body, options.mode);
+
+  const load::Result res { load::run(target, options) };
+  s_results.emplace_back(name, res);
+
+  if (!s_options.json) {
+    const auto& l { res.latency };
+    const double mean { l.count > 0 ? static_cast<double>(l.sum) / static_cast<double>(l.count) / 1e3 : 0.0 };
+    std::println(
+      "{:<40} {:>10.0f} rps  mean {:>8.1f} us  p50 {:>8.1f} us  p90 {:>8.1f} us  p99 {:>8.1f} us  p99.9 {:>8.1f} us  max {:>8.1f} us  errors {}  non-2xx {}",
+      name, res.rps(), mean,
+      l.quantile(0.5) / 1e3, l.quantile(0.9) / 1e3, l.quantile(0.99) / 1e3,
+      l.quantile(0.999) / 1e3, l.quantile(1.0) / 1e3,
+      res.errors, res.unexpected
+    );
+  }
+  return res;
+}
+
+/* one object per run, latencies in microseconds */
+void report() {
+  if (!s_options.json) {
+    return;
+  }
+
+  std::string out { std::format("{{\"duration_ms\":{},\"benchmarks\":[", s_options.load.duration.count()) };
+  for (size_t i = 0; i < s_results.size(); i++) {
+    const auto& [name, res] { s_results[i] };
+    const auto& l { res.latency };
+    out += i > 0 ? ",\n" : "\n";
+    out += "{\"name\":";
+    json::escape(name, out);
+    out += std::format(
+      ",\"requests\":{},\"errors\":{},\"non_2xx\":{},\"rps\":{:.1f},\"mean_us\":{:.1f},"
+      "\"p50_us\":{:.1f},\"p90_us\":{:.1f},\"p99_us\":{:.1f},\"p999_us\":{:.1f},\"max_us\":{:.1f}}}",
+      res.requests, res.errors, res.unexpected, res.rps(),
+      l.count > 0 ? static_cast<double>(l.sum) / static_cast<double>(l.count) / 1e3 : 0.0,
+      l.quantile(0.5) / 1e3, l.quantile(0.9) / 1e3, l.quantile(0.99) / 1e3,
+      l.quantile(0.999) / 1e3, l.quantile(1.0) / 1e3
+    );
+  }
+  out += "\n]}";
+  std::println("{}", out);
+}
+
+bool parse_url(const std::string& url, load::Target& target, std::string& path) {
+  std::string_view rest { url };
+  if (rest.starts_with("http://")) {
+    rest.remove_prefix(7);
+  }
+
+  const size_t slash { rest.find('/') };
+  path = slash == std::string_view::npos ? "/" : std::string { rest.substr(slash) };
+  rest = rest.substr(0, slash);
+
+  const size_t colon { rest.find(':') };
+  target.host = std::string { rest.substr(0, colon) };
+  if (target.host == "localhost") {
+    target.host = "127.0.0.1";
+  }
+
+  if (colon != std::string_view::npos) {
+    const std::string_view port { rest.substr(colon + 1) };
+    const auto [_, error] = std::from_chars(port.data(), port.data() + port.size(), target.port);
+    if (error != std::errc {}) {
+      return false;
+    }
+  }
+  return !target.host.empty();
+}
+
+bool parse_options(int argc, char** argv) {
+  load::Options& load { s_options.load };
+  load.threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+  load.connections = 32;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg { argv[i] };
+    if (arg == "--json") {
+      s_options.json = true;
+      continue;
+    }
+    if (arg == "--close") {
+      load.mode = load::Mode::Close;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      return false;
+    }
+
+    const char* value { argv[++i] };
+    if (arg == "--url") {
+      s_options.url = value;
+    } else if (arg == "--method") {
+      s_options.method = value;
+    } else if (arg == "--body") {
+      s_options.body = value;
+    } else if (arg == "--threads") {
+      load.threads = std::strtoull(value, nullptr, 10);
+    } else if (arg == "--connections") {
+      load.connections = std::strtoull(value, nullptr, 10);
+    } else if (arg == "--duration") {
+      load.duration = std::chrono::milliseconds { std::atoll(value) };
+    } else if (arg == "--rate") {
+      load.rate = std::strtod(value, nullptr);
+    } else {
+      return false;
+    }
+  }
+
+  return load.threads > 0 && load.connections > 0 && load.duration.count() > 0 && load.rate >= 0;
+}
@@ -0,0 +1,392 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+#include <lime.h>
+
+#include "../corpus.h"
+
+namespace http = lime::http;
+namespace json = lime::json;
+
+struct Options {
+  /* print a json document instead of a table */
+  bool        json = false;
+  /* only run benchmarks whose name contains it */
+  std::string filter {};
+  /* directory holding twitter.json, canada.json and citm_catalog.json */
+  std::string corpus {};
+  std::chrono::milliseconds time { 500 };
+};
+
+struct Result {
+  std::string name;
+  uint64_t    iterations;
+  double      ns_per_op;
+  /* bytes processed by one iteration, 0 when throughput means nothing */
+  size_t      bytes;
+};
+
+/* runs a batch of n iterations */
+using Batch = std::function<void(uint64_t n)>;
+
+static Options s_options {};
+static std::vector<Result> s_results {};
+
+static bool parse_options(int argc, char** argv);
+static bool wanted(const std::string& name);
+static void bench(const std::string& name, size_t bytes, const Batch& batch);
+template <typename F>
+static void bench_each(const std::string& name, size_t bytes, F func);
+static void report();
+
+static void parser();
+static void router();
+static void json_corpora();
+static void json_reader();
+static void response();
+static void threadpool();
+
+/* keeps the compiler from dropping a result it can prove unused */
+template <typename T>
+static void keep(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/*
+* usage: micro [--json] [--filter text] [--time ms] [--corpus dir]
+* every benchmark repeats its operation for about --time and reports the
+* time per operation, --json prints the results for tracking over time.
+*/
+int main(int argc, char** argv) {
+  if (!parse_options(argc, argv)) {
+    std::println(stderr, "usage: {} [--json] [--filter text] [--time ms] [--corpus dir]", argv[0]);
+    return 1;
+  }
+
+  lime::logging::level = lime::LogLevel::None;
+
+  parser();
+  router();
+  json_corpora();
+  json_reader();
+  response();
+  threadpool();
+  report();
+}
+
+void parser() {
+  const std::string get {
+    "GET /api/v1/users/42?fields=name,email&page=2 HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:126.0) Gecko/20100101 Firefox/126.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=8f2a61c0b7e94d3a; theme=dark\r\n"
+    "\r\n"
+  };
+
+  const std::string body { corpus::twitter(4) };
+  const std::string post {
+    std::format(
+      "POST /api/v1/tweets HTTP/1.1\r\n"
+      "Host: localhost:8080\r\n"
+      "Content-Type: application/json\r\n"
+      "Content-Length: {}\r\n"
+      "\r\n{}",
+      body.size(), body
+    )
+  };
+
+  http::RequestParser get_parser {};
+  bench_each("parse/get", get.size(), [&get_parser, &get]() {
+    get_parser.feed(get);
+    keep(get_parser.request());
+    get_parser.reset();
+  });
+
+  http::RequestParser post_parser {};
+  bench_each("parse/post", post.size(), [&post_parser, &post]() {
+    post_parser.feed(post);
+    keep(post_parser.request());
+    post_parser.reset();
+  });
+
+  /* as if the request arrived in small tcp segments */
+  http::RequestParser split_parser {};
+  bench_each("parse/get_split_64", get.size(), [&split_parser, &get]() {
+    for (size_t i = 0; i < get.size(); i += 64) {
+      split_parser.feed(std::string_view { get }.substr(i, 64));
+    }
+    keep(split_parser.request());
+    split_parser.reset();
+  });
+}
+
+void router() {
+  const http::RouteFunc handler {
+    [](const http::Request&) {
+      return http::Response { "" };
+    }
+  };
+
+  /* the last route is looked up so linear searches pay for every route */
+  for (const size_t routes: { 10, 100, 1000 }) {
+    http::Router router {};
+    for (size_t i = 0; i < routes; i++) {
+      router.add(std::format("/api/v1/resource{}", i), http::Method::Get, handler);
+    }
+
+    http::Request hit {};
+    hit.method = http::Method::Get;
+    hit.url = std::format("/api/v1/resource{}", routes - 1);
+    bench_each(std::format("route/static/{}", routes), 0, [&router, &hit]() {
+      keep(router.match(hit));
+    });
+
+    http::Request miss {};
+    miss.method = http::Method::Get;
+    miss.url = "/api/v2/missing";
+    bench_each(std::format("route/static_miss/{}", routes), 0, [&router, &miss]() {
+      keep(router.match(miss));
+    });
+  }
+
+  for (const size_t routes: { 10, 100 }) {
+    http::Router router {};
+    for (size_t i = 0; i < routes; i++) {
+      router.add_regex(std::format("/api/v1/resource{}/[0-9]+", i), http::Method::Get, handler);
+    }
+
+    http::Request hit {};
+    hit.method = http::Method::Get;
+    hit.url = std::format("/api/v1/resource{}/1234", routes - 1);
+    bench_each(std::format("route/regex/{}", routes), 0, [&router, &hit]() {
+      keep(router.match(hit));
+    });
+  }
+}
+
+void json_corpora() {
+  const std::pair<const char*, std::function<std::string()>> corpora[] {
+    { "twitter", []() { return corpus::twitter(); } },
+    { "canada", []() { return corpus::canada(); } },
+    { "citm_catalog", []() { return corpus::citm(); } },
+  };
+
+  for (const auto& [name, generate]: corpora) {
+    const std::string decode { std::format("json/decode/{}", name) };
+    const std::string encode { std::format("json/encode/{}", name) };
+    if (!wanted(decode) && !wanted(encode)) {
+      continue;
+    }
+
+    std::string data {};
+    if (!s_options.corpus.empty()) {
+      data = corpus::load(std::format("{}/{}.json", s_options.corpus, name));
+    }
+    if (data.empty()) {
+      data = generate();
+    }
+
+    const auto node { json::decode(data) };
+    if (!node) {
+      std::println(stderr, "{}: not accepted by json::decode, skipped", name);
+      continue;
+    }
+
+    bench_each(decode, data.size(), [&data]() {
+      keep(json::decode(data));
+    });
+
+    std::string buffer {};
+    bench_each(encode, data.size(), [&node, &buffer]() {
+      buffer.clear();
+      json::encode(*node, buffer);
+      keep(buffer);
+    });
+  }
+}
+
+/* reads a document fed in chunks of a fixed size, returns the number of events */
+static size_t read_chunked(std::string_view data, size_t chunk) {
+  json::Reader reader {};
+  size_t pos { 0 }, events { 0 };
+  while (true) {
+    const json::Event event { reader.next() };
+    if (event == json::Event::NeedMore) {
+      if (pos >= data.size()) {
+        reader.finish();
+      } else {
+        reader.feed(data.substr(pos, chunk));
+        pos += chunk;
+      }
+      continue;
+    }
+
+    if (event == json::Event::End || event == json::Event::Error) {
+      return events;
+    }
+    events++;
+  }
+}
+
+/* tokens split between chunks, a long string spans hundreds of them */
+void json_reader() {
+  if (!wanted("json/reader_4k/twitter") && !wanted("json/reader_4k/long_string")) {
+    return;
+  }
+
+  const std::string twitter { corpus::twitter() };
+  bench_each("json/reader_4k/twitter", twitter.size(), [&twitter]() {
+    keep(read_chunked(twitter, 4096));
+  });
+
+  const std::string long_string { std::format("{{\"blob\": \"{}\"}}", std::string(1024 * 1024, 'x')) };
+  bench_each("json/reader_4k/long_string", long_string.size(), [&long_string]() {
+    keep(read_chunked(long_string, 4096));
+  });
+}
+
+void response() {
+  http::Response small { "Hello, World!" };
+  small.set_header("Content-Type", "text/plain");
+  bench_each("response/to_string/small", 0, [&small]() {
+    keep(small.to_string());
+  });
+
+  http::Response large { corpus::twitter(48) };
+  large.set_header("Content-Type", "application/json");
+  large.set_header("Cache-Control", "no-store");
+  large.set_header("X-Request-Id", "8f2a61c0-b7e9-4d3a-9c1e-52d7a0f3b6e4");
+  bench_each("response/to_string/json_16kb", 0, [&large]() {
+    keep(large.to_string());
+  });
+}
+
+void threadpool() {
+  for (const size_t workers: { 1, 4 }) {
+    lime::DynamicThreadPool pool { workers };
+    std::atomic<uint64_t> done { 0 };
+
+    /* enqueue a batch of empty tasks and wait until the workers drained it */
+    bench(std::format("threadpool/enqueue_run/{}", workers), 0, [&pool, &done](uint64_t n) {
+      done.store(0, std::memory_order_relaxed);
+      for (uint64_t i = 0; i < n; i++) {
+        pool.enqueue([&done]() {
+          done.fetch_add(1, std::memory_order_release);
+        });
+      }
+
+      while (done.load(std::memory_order_acquire) < n) {
+        std::this_thread::yield();
+      }
+    });
+
+    pool.shutdown();
+  }
+}
+
+/* doubles the batch until it takes a tenth of the time, then repeats it for the rest */
+void bench(const std::string& name, size_t bytes, const Batch& batch) {
+  using Clock = std::chrono::steady_clock;
+
+  if (!wanted(name)) {
+    return;
+  }
+
+  uint64_t size { 1 };
+  while (true) {
+    const auto begin { Clock::now() };
+    batch(size);
+    if (Clock::now() - begin >= s_options.time / 10 || size >= (uint64_t { 1 } << 32)) {
+      break;
+    }
+    size *= 2;
+  }
+
+  uint64_t iterations { 0 };
+  const auto begin { Clock::now() };
+  auto now { begin };
+  while (now - begin < s_options.time) {
+    batch(size);
+    iterations += size;
+    now = Clock::now();
+  }
+
+  const double ns { std::chrono::duration<double, std::nano>(now - begin).count() };
+  s_results.push_back(Result { name, iterations, ns / static_cast<double>(iterations), bytes });
+
+  if (!s_options.json) {
+    const Result& res { s_results.back() };
+    if (res.bytes > 0) {
+      std::println("{:<32} {:>12.1f} ns/op {:>10.1f} MB/s", res.name, res.ns_per_op, res.bytes * 1e3 / res.ns_per_op);
+    } else {
+      std::println("{:<32} {:>12.1f} ns/op", res.name, res.ns_per_op);
+    }
+  }
+}
+
+template <typename F>
+void bench_each(const std::string& name, size_t bytes, F func) {
+  bench(name, bytes, [&func](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      func();
+    }
+  });
+}
+
+bool wanted(const std::string& name) {
+  return s_options.filter.empty() || name.find(s_options.filter) != std::string::npos;
+}
+
+/* one object per benchmark, names never need escaping */
+void report() {
+  if (!s_options.json) {
+    return;
+  }
+
+  std::string out { std::format("{{\"time_ms\":{},\"benchmarks\":[", s_options.time.count()) };
+  for (size_t i = 0; i < s_results.size(); i++) {
+    const Result& res { s_results[i] };
+    out += std::format(
+      "{}\n{{\"name\":\"{}\",\"iterations\":{},\"ns_per_op\":{:.3f},\"bytes_per_op\":{},\"mb_per_s\":{:.3f}}}",
+      i > 0 ? "," : "", res.name, res.iterations, res.ns_per_op, res.bytes,
+      res.bytes > 0 ? res.bytes * 1e3 / res.ns_per_op : 0.0
+    );
+  }
+  out += "\n]}";
+  std::println("{}", out);
+}
+
+bool parse_options(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg { argv[i] };
+    if (arg == "--json") {
+      s_options.json = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      return false;
+    }
+
+    if (arg == "--filter") {
+      s_options.filter = argv[++i];
+    } else if (arg == "--corpus") {
+      s_options.corpus = argv[++i];
+    } else if (arg == "--time") {
+      s_options.time = std::chrono::milliseconds { std::atoll(argv[++i]) };
+    } else {
+      return false;
+    }
+  }
+
+  return s_options.time.count() > 0;
+}
@@ -11,7 +11,7 @@ int main() {
   });
 
   http::Server server(router);
-  if(server.port(8080).run() < 0) {
+  if(server.port(8080).handle_signals(true).run() < 0) {
     std::println("failed to run server: {}", strerror(errno));
     exit(EXIT_FAILURE);
   }
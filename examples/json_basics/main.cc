@@ -74,8 +74,10 @@ void decoding() {
   // type() or get() methods can be used
   json::Object& root = root_node.get<json::Object>();
 
-  // json::Object is nothing but a wrapper around std::unordered_map
-  // all functions of std::unordered_map are available
+  // json::Object is a std::unordered_map, so it offers contains,
+  // at, insert and find. The members only keep their order with
+  // json::OrderedObject, or when the library and your code are
+  // built with JSON_ORDERED_OBJECT=1
   if(root.contains("user-name")) {
     auto& user_name_node = root.at("user-name");
     // to check the type use type() on any node
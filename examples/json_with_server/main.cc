@@ -49,7 +49,7 @@ int main() {
   router.add("/user", http::Method::Get, user);
 
   http::Server server(router);
-  if(server.run() < 0) {
+  if(server.handle_signals(true).run() < 0) {
     std::println(stderr, "failed to run server: {}", strerror(errno));
     exit(EXIT_FAILURE);
   }
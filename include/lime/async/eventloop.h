@@ -0,0 +1,268 @@
+#ifndef LIME_ASYNC_EVENTLOOP_H
+#define LIME_ASYNC_EVENTLOOP_H
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include <sys/types.h>
+
+#include "task.h"
+#include "timerwheel.h"
+#include "../threadpool/threadpool.h"
+
+namespace lime {
+  class EventLoop {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using IOCallback = std::function<void(uint32_t)>;
+    using TimerId = TimerWheel::TimerId;
+
+    enum Event : uint32_t {
+      Readable = 1 << 0,
+      Writable = 1 << 1,
+      Hangup   = 1 << 2,
+    };
+
+    /*
+    * @brief Create a new event loop.
+    * @param pool Thread pool used by offload(), may be null.
+    */
+    explicit EventLoop(DynamicThreadPool* pool = nullptr);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /*
+    * @brief Run the loop on the calling thread until stop() is called.
+    * @return Returns 0 on success or negative number on error, check errno for more details.
+    */
+    [[nodiscard]]
+    int run();
+
+    /*
+    * @brief Ask the loop to return from run(), safe to call from any thread.
+    */
+    void stop();
+
+    /*
+    * @brief Queue a callback to run on the loop thread, safe to call from any thread.
+    * @param func Callback.
+    */
+    void post(Callback func);
+
+    /*
+    * @brief Watch a file descriptor for readiness, must be called on the loop thread.
+    *        Watching an already watched fd replaces its events and callback.
+    * @param fd File descriptor.
+    * @param events Mask of EventLoop::Event.
+    * @param func Callback receiving the ready events.
+    * @return Returns 0 on success or negative number on error, check errno for more details.
+    */
+    [[nodiscard]]
+    int watch(int fd, uint32_t events, IOCallback func);
+
+    /*
+    * @brief Stop watching a file descriptor, must be called on the loop thread.
+    * @param fd File descriptor.
+    */
+    void unwatch(int fd);
+
+    /*
+    * @brief Run a callback once after the given delay, must be called on the loop thread.
+    * @param delay Delay.
+    * @param func Callback.
+    * @return Id which can be passed to cancel_timer().
+    */
+    TimerId add_timer(std::chrono::milliseconds delay, Callback func);
+
+    /*
+    * @brief Cancel a pending timer, cancelling a fired timer is a no-op.
+    * @param id Timer id.
+    */
+    void cancel_timer(TimerId id);
+
+    /*
+    * @brief Get the thread pool used by offload().
+    * @return Pointer to the pool or null.
+    */
+    [[nodiscard]]
+    DynamicThreadPool* pool() const;
+
+    /*
+    * @brief Get the loop running on the calling thread.
+    * @return Pointer to the loop or null when not called from a loop thread.
+    */
+    [[nodiscard]]
+    static EventLoop* current();
+
+    /* awaitable which resumes once fd has any of the given events */
+    struct IOAwaiter {
+      [[nodiscard]]
+      bool await_ready() const noexcept { return false; }
+      bool await_suspend(std::coroutine_handle<> handle);
+      uint32_t await_resume() const noexcept { return revents; }
+
+      EventLoop* loop;
+      int        fd;
+      uint32_t   events;
+      uint32_t   revents = 0;
+    };
+
+    /* awaitable which resumes after a delay */
+    struct SleepAwaiter {
+      [[nodiscard]]
+      bool await_ready() const noexcept { return delay.count() <= 0; }
+      void await_suspend(std::coroutine_handle<> handle);
+      void await_resume() const noexcept {}
+
+      EventLoop*                loop;
+      std::chrono::milliseconds delay;
+    };
+
+    /* awaitable which runs a function on the thread pool and resumes on the loop */
+    template <typename F>
+    struct OffloadAwaiter {
+      using Result = std::invoke_result_t<F>;
+      using Storage = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+      [[nodiscard]]
+      bool await_ready() const noexcept { return false; }
+
+      void await_suspend(std::coroutine_handle<> handle) {
+        const auto run = [this, handle]() {
+          try {
+            if constexpr (std::is_void_v<Result>) {
+              func();
+            } else {
+              result.emplace(func());
+            }
+          } catch (...) {
+            exception = std::current_exception();
+          }
+          loop->post([handle]() { handle.resume(); });
+        };
+
+        if (loop->pool() == nullptr) {
+          run();
+          return;
+        }
+        loop->pool()->enqueue(run);
+      }
+
+      Result await_resume() {
+        if (exception) {
+          std::rethrow_exception(exception);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+          return std::move(*result);
+        }
+      }
+
+      EventLoop*             loop;
+      F                      func;
+      std::optional<Storage> result;
+      std::exception_ptr     exception;
+    };
+
+    /*
+    * @brief Suspend until fd becomes readable.
+    * @param fd File descriptor.
+    */
+    [[nodiscard]]
+    IOAwaiter readable(int fd);
+
+    /*
+    * @brief Suspend until fd becomes writable.
+    * @param fd File descriptor.
+    */
+    [[nodiscard]]
+    IOAwaiter writable(int fd);
+
+    /*
+    * @brief Suspend for the given duration without blocking the loop.
+    * @param delay Duration.
+    */
+    [[nodiscard]]
+    SleepAwaiter sleep(std::chrono::milliseconds delay);
+
+    /*
+    * @brief Run a blocking function on the thread pool and resume on the loop with its result.
+    * @param func Function to run.
+    */
+    template <typename F>
+    [[nodiscard]]
+    OffloadAwaiter<std::decay_t<F>> offload(F&& func) {
+      return { this, std::forward<F>(func), std::nullopt, nullptr };
+    }
+
+    /*
+    * @brief Read from a non-blocking fd, suspending until data is available.
+    * @return Bytes read, 0 on end of stream or negative number on error, check errno for more details.
+    */
+    [[nodiscard]]
+    Task<ssize_t> read(int fd, void* buffer, size_t len);
+
+    /*
+    * @brief Write the entire buffer to a non-blocking fd, suspending while the fd is full.
+    * @return Bytes written or negative number on error, check errno for more details.
+    */
+    [[nodiscard]]
+    Task<ssize_t> write(int fd, const void* buffer, size_t len);
+
+  private:
+    struct Watcher {
+      uint32_t   events;
+      IOCallback func;
+    };
+
+    void wakeup();
+    void run_posted();
+    [[nodiscard]]
+    int poll_timeout() const;
+    [[nodiscard]]
+    int wait(int timeout);
+
+    DynamicThreadPool* m_pool;
+    int                m_backend;
+    int                m_wakeup[2];
+    std::atomic<bool>  m_stop = false;
+
+    std::unordered_map<int, std::shared_ptr<Watcher>> m_watchers;
+
+    TimerWheel m_timers;
+
+    std::vector<Callback> m_posted;
+    std::mutex            m_posted_mutex;
+  };
+
+  /*
+  * @brief Suspend the current task without blocking the loop it runs on.
+  * @param delay Duration.
+  */
+  [[nodiscard]]
+  EventLoop::SleepAwaiter sleep(std::chrono::milliseconds delay);
+
+  /*
+  * @brief Run a blocking function on the current loop's thread pool.
+  * @param func Function to run.
+  */
+  template <typename F>
+  [[nodiscard]]
+  auto offload(F&& func) {
+    return EventLoop::current()->offload(std::forward<F>(func));
+  }
+} // lime
+
+#endif // LIME_ASYNC_EVENTLOOP_H
@@ -0,0 +1,163 @@
+#ifndef LIME_ASYNC_TASK_H
+#define LIME_ASYNC_TASK_H
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace lime {
+  template <typename T = void>
+  class Task;
+
+  namespace detail {
+    struct TaskPromiseBase {
+      struct FinalAwaiter {
+        [[nodiscard]]
+        bool await_ready() const noexcept { return false; }
+
+        /* resume whoever was awaiting this task (symmetric transfer) */
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+          return handle.promise().continuation;
+        }
+
+        void await_resume() const noexcept {}
+      };
+
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+      FinalAwaiter final_suspend() const noexcept { return {}; }
+      void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+      std::coroutine_handle<> continuation = std::noop_coroutine();
+      std::exception_ptr      exception;
+    };
+
+    template <typename T>
+    struct TaskPromise : TaskPromiseBase {
+      Task<T> get_return_object() noexcept;
+
+      template <typename U>
+      void return_value(U&& value) {
+        result.emplace(std::forward<U>(value));
+      }
+
+      T get() {
+        if (exception) {
+          std::rethrow_exception(exception);
+        }
+        return std::move(*result);
+      }
+
+      std::optional<T> result;
+    };
+
+    template <>
+    struct TaskPromise<void> : TaskPromiseBase {
+      Task<void> get_return_object() noexcept;
+
+      void return_void() const noexcept {}
+
+      void get() const {
+        if (exception) {
+          std::rethrow_exception(exception);
+        }
+      }
+    };
+  } // detail
+
+  /*
+  * @brief Lazily started coroutine producing a value of type T.
+  *        The coroutine body runs when the task is first awaited,
+  *        and the awaiter is resumed on whichever thread completes it.
+  */
+  template <typename T>
+  class [[nodiscard]] Task {
+  public:
+    using promise_type = detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(handle_type handle) : m_handle(handle) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+      if (this != &other) {
+        if (m_handle) {
+          m_handle.destroy();
+        }
+        m_handle = std::exchange(other.m_handle, {});
+      }
+      return *this;
+    }
+
+    ~Task() {
+      if (m_handle) {
+        m_handle.destroy();
+      }
+    }
+
+    auto operator co_await() && noexcept {
+      struct Awaiter {
+        [[nodiscard]]
+        bool await_ready() const noexcept {
+          return !handle || handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+          handle.promise().continuation = awaiting;
+          return handle;
+        }
+
+        T await_resume() {
+          return handle.promise().get();
+        }
+
+        handle_type handle;
+      };
+
+      return Awaiter { m_handle };
+    }
+
+  private:
+    handle_type m_handle {};
+  };
+
+  namespace detail {
+    template <typename T>
+    inline Task<T> TaskPromise<T>::get_return_object() noexcept {
+      return Task<T> { std::coroutine_handle<TaskPromise<T>>::from_promise(*this) };
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+      return Task<void> { std::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+    }
+
+    /* eagerly started coroutine which frees itself on completion */
+    struct Detached {
+      struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+      };
+    };
+  } // detail
+
+  /*
+  * @brief Start a task without waiting for it, the task owns itself until it finishes.
+  * @param task Task to run, it must not let exceptions escape.
+  */
+  inline void spawn(Task<void> task) {
+    [](Task<void> t) -> detail::Detached {
+      co_await std::move(t);
+    }(std::move(task));
+  }
+} // lime
+
+#endif // LIME_ASYNC_TASK_H
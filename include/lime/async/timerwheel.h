@@ -0,0 +1,96 @@
+#ifndef LIME_ASYNC_TIMERWHEEL_H
+#define LIME_ASYNC_TIMERWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace lime {
+  /*
+  * Hierarchical timer wheel with O(1) insertion and cancellation,
+  * timers are kept in millisecond ticks and cascaded into finer
+  * levels as their deadline approaches.
+  */
+  class TimerWheel {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+
+    static constexpr size_t LevelBits = 6;
+    static constexpr size_t Slots = 1 << LevelBits;
+    static constexpr size_t Levels = 4;
+
+    explicit TimerWheel(Clock::time_point now = Clock::now());
+
+    /*
+    * @brief Schedule a callback, deadlines are rounded up to the next millisecond.
+    * @param deadline Point in time after which the callback runs.
+    * @param func Callback.
+    * @return Id which can be passed to cancel().
+    */
+    TimerId add(Clock::time_point deadline, Callback func);
+
+    /*
+    * @brief Cancel a pending timer, cancelling a fired timer is a no-op.
+    * @param id Timer id.
+    */
+    void cancel(TimerId id);
+
+    /*
+    * @brief Fire every timer whose deadline is not after now.
+    * @param now Current time.
+    */
+    void advance(Clock::time_point now);
+
+    /*
+    * @brief Get how long the caller can sleep before advance() has work to do.
+    * @param now Current time.
+    * @return Delay or std::nullopt when no timers are pending.
+    */
+    [[nodiscard]]
+    std::optional<std::chrono::milliseconds> next_timeout(Clock::time_point now) const;
+
+    /*
+    * @brief Get the number of pending timers.
+    * @return Count.
+    */
+    [[nodiscard]]
+    size_t size() const;
+
+  private:
+    struct Timer {
+      TimerId  id;
+      uint64_t deadline;
+      Callback func;
+    };
+
+    using Slot = std::list<Timer>;
+
+    struct Location {
+      size_t          level;
+      size_t          slot;
+      Slot::iterator  it;
+    };
+
+    [[nodiscard]]
+    uint64_t to_tick(Clock::time_point) const;
+    void place(Slot& from, Slot::iterator it);
+    void cascade(size_t level);
+    void tick();
+
+    Clock::time_point m_start;
+    uint64_t          m_current = 0;
+    TimerId           m_next_id = 1;
+
+    std::array<std::array<Slot, Slots>, Levels> m_wheel {};
+    std::unordered_map<TimerId, Location>       m_index;
+  };
+} // lime
+
+#endif // LIME_ASYNC_TIMERWHEEL_H
@@ -0,0 +1,101 @@
+#ifndef LIME_HTTP_ACCESSLOG_H
+#define LIME_HTTP_ACCESSLOG_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <netinet/in.h>
+
+#include "methods.h"
+#include "status.h"
+
+namespace lime {
+  namespace http {
+    struct AccessLog {
+      enum class Format {
+        /*
+        * one json object per line:
+        * {"ts":1760000000000000,"method":"GET","path":"/","status":200,"bytes":98,"latency_us":42,"peer":"127.0.0.1:51234"}
+        */
+        Json,
+        /*
+        * records of native byte order fields, in this order:
+        * u32 record size, u64 unix time in us, u32 latency in us, u64 bytes,
+        * u32 peer address in network order, u16 peer port, u16 status,
+        * u8 method, then the path up to the record size
+        */
+        Binary,
+      };
+
+      /* records are only written when enabled */
+      bool                      enabled = false;
+      Format                    format = Format::Json;
+      /* share of requests logged, from 0 to 1 */
+      double                    sample = 1.0;
+      /* requests taking at least this long are always logged, a zero duration disables it */
+      std::chrono::milliseconds slow { 0 };
+    };
+
+    struct AccessRecord {
+      Method                                method;
+      std::string_view                      path;
+      StatusCode                            status;
+      /* bytes of the response sent */
+      size_t                                bytes;
+      /* from the first byte of the request until the response is sent */
+      std::chrono::microseconds             latency;
+      sockaddr_in                           peer;
+      std::chrono::system_clock::time_point time;
+    };
+
+    /*
+    * Decides which requests are logged and encodes their records for
+    * lime::access_log(). Not thread safe, a server only uses it on its loop thread.
+    */
+    class AccessLogger {
+    public:
+      AccessLogger();
+
+      /*
+      * @brief Set the options.
+      * @param options Options.
+      */
+      void options(const AccessLog& options);
+
+      [[nodiscard]]
+      const AccessLog& options() const;
+
+      /*
+      * @brief Check if a request is logged, slow requests always are and the rest are sampled.
+      * @param latency Latency of the request.
+      * @return True if its record should be written.
+      */
+      [[nodiscard]]
+      bool wants(std::chrono::microseconds latency);
+
+      /*
+      * @brief Encode a record and queue it on the logger.
+      * @param record Record.
+      */
+      void log(const AccessRecord& record);
+
+      /*
+      * @brief Encode a record.
+      * @param record Record.
+      * @param format Format.
+      * @param out Buffer to append to.
+      */
+      static void encode(const AccessRecord& record, const AccessLog::Format& format, std::string& out);
+
+    private:
+      AccessLog   m_options;
+      /* requests are logged when the next random number is below it */
+      uint64_t    m_threshold = 0;
+      uint64_t    m_state;
+      std::string m_buffer;
+    };
+  } // http
+} // lime
+
+#endif // LIME_HTTP_ACCESSLOG_H
@@ -0,0 +1,149 @@
+#ifndef LIME_HTTP_CACHE_H
+#define LIME_HTTP_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "request.h"
+#include "status.h"
+#include "../metrics/metrics.h"
+
+#ifndef CACHE_SHARDS
+  /* independently locked parts of a response cache, keys are spread over them by hash */
+  #define CACHE_SHARDS 16
+#endif
+
+#ifndef CACHE_CAPACITY
+  /* bytes of serialized responses a server keeps by default */
+  #define CACHE_CAPACITY (64 * 1024 * 1024)
+#endif
+
+namespace lime {
+  namespace http {
+    /* how the responses of a route are cached, see Router::cache() */
+    struct CachePolicy {
+      /* how long a response is served from the cache */
+      std::chrono::milliseconds               ttl { 1000 };
+      /* query parameters telling responses apart, every parameter when not set */
+      std::optional<std::vector<std::string>> params {};
+      /* request headers telling responses apart, like "Accept-Language" */
+      std::vector<std::string>                headers {};
+    };
+
+    /*
+    * A serialized response as it is sent with "Connection: keep-alive",
+    * the value of the Connection header is swapped for connections closing.
+    */
+    struct CachedResponse {
+      StatusCode                            status;
+      std::string                           data;
+      /* offset of the value of the Connection header in data */
+      size_t                                connection;
+      std::chrono::steady_clock::time_point expires;
+      /* value of the ETag header of a successful response, empty without one */
+      std::string                           etag {};
+
+      /*
+      * @brief Get the bytes to send.
+      * @param keep_alive Value of the Connection header.
+      * @return Serialized response.
+      */
+      [[nodiscard]]
+      std::string serialize(const bool keep_alive) const;
+    };
+
+    /*
+    * Serialized responses by key, bounded in bytes with least recently used
+    * eviction. Keys are spread over shards with a lock each, so the loop
+    * thread looking responses up rarely waits for a worker storing one.
+    */
+    class ResponseCache {
+    public:
+      /*
+      * @brief Create an empty cache.
+      * @param capacity Bytes of responses kept, split evenly between the shards.
+      */
+      explicit ResponseCache(size_t capacity = CACHE_CAPACITY);
+      ~ResponseCache();
+
+      /*
+      * @brief Build the key of a request.
+      * @param request Request.
+      * @param policy Policy of its route.
+      * @return Key of the method, url and the parameters and headers the policy selects.
+      */
+      [[nodiscard]]
+      static std::string key(const Request& request, const CachePolicy& policy);
+
+      /*
+      * @brief Look a response up, expired ones are dropped.
+      * @param key Key.
+      * @return Response or null.
+      */
+      [[nodiscard]]
+      std::shared_ptr<const CachedResponse> find(std::string_view key);
+
+      /*
+      * @brief Store a response, replacing the one stored under the key,
+      *        responses larger than a shard are not stored.
+      * @param key Key.
+      * @param response Response.
+      */
+      void insert(const std::string& key, std::shared_ptr<const CachedResponse> response);
+
+      void erase(std::string_view key);
+      void clear();
+
+      /* a smaller capacity evicts on the next insert of each shard */
+      void capacity(size_t bytes);
+
+      [[nodiscard]]
+      size_t capacity() const;
+
+      /*
+      * @brief Get the number of responses stored, expired ones included until they are looked up or evicted.
+      * @return Responses.
+      */
+      [[nodiscard]]
+      size_t size() const;
+
+      [[nodiscard]]
+      size_t bytes() const;
+
+    private:
+      using Entry = std::pair<std::string, std::shared_ptr<const CachedResponse>>;
+
+      struct Shard {
+        mutable std::mutex mutex;
+        /* most recently used first */
+        std::list<Entry>   entries;
+        /* keys point into entries */
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+        size_t             bytes = 0;
+      };
+
+      [[nodiscard]]
+      Shard& shard(std::string_view key);
+      void remove(Shard& shard, std::list<Entry>::iterator it);
+
+      std::array<Shard, CACHE_SHARDS> m_shards;
+      std::atomic<size_t>             m_capacity;
+      metrics::Counter&               m_hits;
+      metrics::Counter&               m_misses;
+      metrics::Counter&               m_evictions;
+      metrics::Gauge&                 m_bytes;
+    };
+  } // http
+} // lime
+
+#endif // LIME_HTTP_CACHE_H
@@ -0,0 +1,27 @@
+#ifndef LIME_HTTP_HEADER_H
+#define LIME_HTTP_HEADER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace lime {
+  namespace http {
+    /* hashes header names ignoring ascii case, "Content-Length" and "content-length" are the same header */
+    struct HeaderHash {
+      [[nodiscard]]
+      size_t operator()(std::string_view name) const;
+    };
+
+    struct HeaderEqual {
+      [[nodiscard]]
+      bool operator()(std::string_view lhs, std::string_view rhs) const;
+    };
+
+    /* header fields by name, looked up ignoring case and sent with the case they were set with */
+    using Header = std::unordered_map<std::string, std::string, HeaderHash, HeaderEqual>;
+  } // http
+} // lime
+
+#endif // LIME_HTTP_HEADER_H
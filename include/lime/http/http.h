@@ -1,6 +1,9 @@
 #ifndef LIME_HTTP_H
 #define LIME_HTTP_H
 
+#include "accesslog.h"
+#include "cache.h"
+#include "header.h"
 #include "methods.h"
 #include "request.h"
 #include "response.h"
@@ -0,0 +1,127 @@
+#ifndef LIME_HTTP_PARSER_H
+#define LIME_HTTP_PARSER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "request.h"
+#include "status.h"
+
+#ifndef REQUEST_LINE_OVERHEAD
+  /* room for the method, version and separators around the url */
+  #define REQUEST_LINE_OVERHEAD 32
+#endif
+
+namespace lime {
+  namespace http {
+    struct Limits {
+      /* longest accepted url including parameters, 414 above it */
+      size_t uri_length   = 8 * 1024;
+      /* total size of all header lines, 431 above it */
+      size_t header_bytes = 16 * 1024;
+      /* number of header lines, 431 above it */
+      size_t header_count = 100;
+      /* Content-Length of the body, 413 above it */
+      size_t body_bytes   = 8 * 1024 * 1024;
+    };
+
+    /*
+    * Incremental http request parser, bytes are fed as they arrive
+    * from the socket and the request is built once it is complete.
+    */
+    class RequestParser {
+    public:
+      enum class State {
+        Incomplete,
+        Complete,
+        Error,
+      };
+
+      /*
+      * @brief Create a parser which rejects requests exceeding the limits.
+      * @param limits Size limits.
+      */
+      explicit RequestParser(const Limits& limits = {});
+
+      /*
+      * @brief Append bytes received from the client and continue parsing.
+      * @param data Received bytes.
+      * @return State of the parser after consuming the data.
+      */
+      State feed(std::string_view data);
+
+      /*
+      * @brief Get the parsed request, valid once feed() returned State::Complete.
+      * @return Request.
+      */
+      [[nodiscard]]
+      Request& request();
+
+      /*
+      * @brief Get the status code to answer with, valid once feed() returned State::Error.
+      * @return StatusCode.
+      */
+      [[nodiscard]]
+      StatusCode error() const;
+
+      /*
+      * @brief Get the current state of the parser.
+      * @return State.
+      */
+      [[nodiscard]]
+      State state() const;
+
+      /*
+      * @brief Check if no byte of the next request has been received yet.
+      * @return True when idle.
+      */
+      [[nodiscard]]
+      bool idle() const;
+
+      /*
+      * @brief Check if the request line and headers have been parsed.
+      * @return True once only the body is left to read.
+      */
+      [[nodiscard]]
+      bool head_done() const;
+
+      /*
+      * @brief Check if the client asked to keep the connection open, valid once the head is parsed.
+      * @return True for HTTP/1.1 without "Connection: close" or HTTP/1.0 with "Connection: keep-alive".
+      */
+      [[nodiscard]]
+      bool keep_alive() const;
+
+      /*
+      * @brief Prepare for the next request on the same connection,
+      *        bytes received past the previous request are kept.
+      */
+      void reset();
+
+    private:
+      enum class Stage {
+        Head,
+        Body,
+        Done,
+      };
+
+      State fail(const StatusCode&);
+      State check_partial_head();
+      State parse_head(size_t end);
+
+      Limits      m_limits;
+      std::string m_buffer;
+      size_t      m_scanned = 0;
+      size_t      m_consumed = 0;
+      size_t      m_body_length = 0;
+      bool        m_keep_alive = false;
+      Stage       m_stage = Stage::Head;
+      State       m_state = State::Incomplete;
+      StatusCode  m_error = StatusCode::BadRequest;
+      Request     m_request {};
+    };
+  } // http
+} // lime
+
+#endif // LIME_HTTP_PARSER_H
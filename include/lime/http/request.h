@@ -1,21 +1,25 @@
 #ifndef LIME_HTTP_REQUEST_H
 #define LIME_HTTP_REQUEST_H
 
+#include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
+#include "header.h"
 #include "methods.h"
+#include "../trace/trace.h"
 
 namespace lime {
   namespace http {
-    using Header = std::unordered_map<std::string, std::string>;
-
     struct Request {
       Method      method;
       std::string url;
       std::unordered_map<std::string, std::string> params;
       Header      header;
       std::string body;
+      /* when each phase of the request was reached, see trace::Phase */
+      trace::Timings timings;
 
       /*
       * @brief Get array of segments of URL, example: if the url is /foo/bar/baz the array is [foo, bar, baz].
@@ -23,6 +27,15 @@ namespace lime {
       */
       [[nodiscard]]
       std::vector<std::string> segments() const;
+
+      /*
+      * @brief Check if the client already holds a version of the resource, so a handler
+      *        can answer 304 Not Modified before building the body.
+      * @param tag Entity tag, quoted or not.
+      * @return True when If-None-Match lists the tag or "*", W/ prefixes are ignored.
+      */
+      [[nodiscard]]
+      bool not_modified(std::string_view tag) const;
     };
   } // http
 } // lime
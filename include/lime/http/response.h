@@ -2,14 +2,14 @@
 #define LIME_HTTP_RESPONSE_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
+#include "header.h"
 #include "status.h"
 
 namespace lime {
   namespace http {
-    using Header = std::unordered_map<std::string, std::string>;
-
     struct Response {
     public:
       /*
@@ -18,6 +18,12 @@ namespace lime {
       */
       Response(const std::string& body);
 
+      /*
+      * @brief Create http reponse with http::StatusOk taking over the given body without copying.
+      * @param body Body of the http response.
+      */
+      Response(std::string&& body);
+
       /*
       * @brief Create http reponse with http statuscode.
       * @param status_code Status code of the http response.
@@ -31,6 +37,13 @@ namespace lime {
       */
       Response(const std::string&,const StatusCode&);
 
+      /*
+      * @brief Create http reponse with http statuscode taking over the given body without copying.
+      * @param body Body of the http response.
+      * @param status_code Status code of the http response.
+      */
+      Response(std::string&&, const StatusCode&);
+
       /*
       * @brief Append http options to the headers of the response.
       * @param id Name of the key.
@@ -38,18 +51,68 @@ namespace lime {
       */
       void append_header(const std::string& id, const std::string& value);
 
+      /*
+      * @brief Set a http header of the response, replacing any previous value.
+      * @param id Name of the key.
+      * @param value Value of the field.
+      */
+      void set_header(const std::string& id, const std::string& value);
+
+      /*
+      * @brief Remove a http header of the response.
+      * @param id Name of the key.
+      */
+      void remove_header(const std::string& id);
+
+      /*
+      * @brief Set the ETag header, a request sending it back in If-None-Match is answered
+      *        with 304 Not Modified, see Request::not_modified().
+      * @param tag Version of the body, quoted by this function.
+      * @param weak Mark the tag weak, for bodies equivalent but not identical byte for byte.
+      */
+      void set_etag(const std::string& tag, const bool weak = false);
+
       /*
       * @brief Set the message body of the response.
       * @param body Body of the http response.
       */
       void set_body(const std::string& body);
 
+      /*
+      * @brief Set the message body of the response without copying it,
+      *        a buffer filled by json::encode(node, buffer) can be moved in.
+      * @param body Body of the http response.
+      */
+      void set_body(std::string&& body);
+
       /*
       * @brief Set the statuscode of the response.
       * @param status_code Status code of the http response.
       */
       void set_code(const StatusCode& status_code);
 
+      /*
+      * @brief Get the statuscode of the response.
+      * @return Status code of the http response.
+      */
+      [[nodiscard]]
+      const StatusCode& code() const;
+
+      /*
+      * @brief Get a http header of the response.
+      * @param id Name of the key.
+      * @return Value or null if it is not set.
+      */
+      [[nodiscard]]
+      const std::string* header(const std::string& id) const;
+
+      /*
+      * @brief Get the message body of the response.
+      * @return Body of the http response.
+      */
+      [[nodiscard]]
+      const std::string& body() const;
+
       /*
       * @brief Convert http response to string.
       * @return String fromat of the http reponse.
@@ -62,6 +125,14 @@ namespace lime {
       StatusCode  m_code;
       Header      m_header;
     };
+
+    /*
+    * @brief Hash a body into an entity tag for Response::set_etag(), fast but not cryptographic.
+    * @param body Body of the http response.
+    * @return Tag of 16 hex digits.
+    */
+    [[nodiscard]]
+    std::string etag(std::string_view body);
   } // http
 } // lime
 
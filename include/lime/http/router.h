@@ -5,7 +5,10 @@
 #include <unordered_map>
 #include <string>
 #include <regex>
+#include <variant>
 
+#include "../async/task.h"
+#include "cache.h"
 #include "response.h"
 #include "request.h"
 #include "methods.h"
@@ -13,6 +16,17 @@
 namespace lime {
   namespace http {
     using RouteFunc = std::function<Response(const Request&)>;
+    using AsyncRouteFunc = std::function<Task<Response>(const Request&)>;
+    using Handler = std::variant<RouteFunc, AsyncRouteFunc>;
+
+    /* a handler with the path or regex and method it was added with */
+    struct Route {
+      std::string path;
+      Method      method;
+      Handler     handler;
+      /* responses are served from the server's cache when set */
+      std::optional<CachePolicy> cache {};
+    };
 
     struct RegexWrapper {
       std::regex  regex; /* regex */
@@ -37,12 +51,69 @@ namespace lime {
       */
       void add_regex(const std::string&, const Method&, const RouteFunc&);
 
+      /*
+      * @brief Adds new route whose handler is a coroutine, it runs on the server's event loop
+      *        and must not block, use lime::offload() for blocking work.
+      * @param path Url path.
+      * @param method Http Method
+      * @param handler Http Request handler coroutine
+      */
+      void add(const std::string& path, const Method& method, const AsyncRouteFunc& handler);
+
+      /*
+      * @brief Adds new regex based route whose handler is a coroutine.
+      * @param path Url path.
+      * @param method Http Method
+      * @param handler Http Request handler coroutine
+      */
+      void add_regex(const std::string&, const Method&, const AsyncRouteFunc&);
+
+      /*
+      * @brief Cache the responses of a route, a request finding a fresh 2xx response skips the handler
+      *        and requests arriving while it runs wait for its response. Adding the route again drops the policy.
+      * @param path Url path or regex the route was added with.
+      * @param method Http Method
+      * @param policy How long responses are kept and what tells them apart.
+      *        Responses setting cookies or with "Cache-Control: private" or "no-store" are neither kept nor shared.
+      * Throws std::invalid_argument if there is no such route or the method is not GET.
+      */
+      void cache(const std::string& path, const Method& method, const CachePolicy& policy);
+
+      /*
+      * @brief Adds a GET route serving lime::metrics::registry() in the Prometheus text format,
+      *        rendered on a pool worker, see Server::admin_port() to serve it apart from other traffic.
+      * @param path Url path.
+      */
+      void add_metrics(const std::string& path = "/metrics");
+
+      /*
+      * @brief Adds a GET route dumping the requests kept by trace::enable() as Chrome trace event json.
+      * @param path Url path.
+      */
+      void add_trace(const std::string& path = "/debug/trace");
+
+      /*
+      * @brief Find the handler for a request.
+      * @param request Parsed http request.
+      * @return Pointer to the handler or null if no route matches.
+      */
       [[nodiscard]]
-      std::string handle(const int&) const;
+      const Handler* match(const Request& request) const;
+
+      /*
+      * @brief Find the route for a request.
+      * @param request Parsed http request.
+      * @return Pointer to the route or null if no route matches.
+      */
+      [[nodiscard]]
+      const Route* find(const Request& request) const;
 
     private:
+      void add_handler(const std::string&, const Method&, Handler);
+      void add_regex_handler(const std::string&, const Method&, Handler);
+
       // TODO: simplify whatever fuck this is!
-      using RouteMethodTable = std::unordered_map<http::Method, RouteFunc>;
+      using RouteMethodTable = std::unordered_map<http::Method, Route>;
       std::unordered_map<std::string, RouteMethodTable> m_static_routes;
       std::vector<std::pair<RegexWrapper, RouteMethodTable>> m_regex_routes;
     };
@@ -1,14 +1,54 @@
 #ifndef LIME_HTTP_SERVER_H
 #define LIME_HTTP_SERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <array>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include <arpa/inet.h>
 
+#include "accesslog.h"
+#include "cache.h"
+#include "parser.h"
 #include "router.h"
+#include "../async/eventloop.h"
+#include "../metrics/metrics.h"
 #include "../threadpool/threadpool.h"
 
 namespace lime {
   namespace http {
+    struct Connection;
+    struct Reply;
+    enum class Phase;
+
+    struct Timeouts {
+      /* from accepting a connection or the first byte of a request until its headers are read */
+      std::chrono::milliseconds header_read { 10000 };
+      /* from the end of the headers until the whole body is read */
+      std::chrono::milliseconds body_read   { 30000 };
+      /* for writing the whole response */
+      std::chrono::milliseconds write       { 30000 };
+      /* idle time allowed between requests on a kept alive connection */
+      std::chrono::milliseconds keep_alive  { 5000 };
+      /* how long a shutdown waits for requests in progress when none is given to stop() */
+      std::chrono::milliseconds drain       { 10000 };
+    };
+
+    struct DrainReport {
+      /* connections closed gracefully during the shutdown */
+      size_t drained = 0;
+      /* connections closed at the deadline with a request still in progress */
+      size_t aborted = 0;
+    };
+
     class Server {
     public:
       /*
@@ -18,7 +58,15 @@ namespace lime {
       explicit Server(const Router& router, const size_t max_workers = std::thread::hardware_concurrency());
 
       /*
-      * @brief Set server port.
+      * @brief Stops the server if it is still running, connections in progress are aborted.
+      */
+      ~Server();
+
+      Server(const Server&) = delete;
+      Server& operator=(const Server&) = delete;
+
+      /*
+      * @brief Set server port, 0 lets the system pick a free port which port() returns once started.
       * @param port Port.
       */
       Server& port(const uint16_t& port);
@@ -29,6 +77,47 @@ namespace lime {
       */
       Server& addrs(const std::string& addrs);
 
+      /*
+      * @brief Set connection timeouts, a zero duration disables that timeout.
+      * @param timeouts Timeouts.
+      */
+      Server& timeouts(const Timeouts& timeouts);
+
+      /*
+      * @brief Set request size limits, requests above them are rejected before they are read completely.
+      * @param limits Limits.
+      */
+      Server& limits(const Limits& limits);
+
+      /*
+      * @brief Stop gracefully on SIGINT and SIGTERM, disabled by default.
+      *        The signals are blocked on the thread calling start() and read by the server,
+      *        run() unblocks them again when it returns. Enable it for one server per process only.
+      * @param enable Enable signal handling.
+      */
+      Server& handle_signals(const bool enable);
+
+      /*
+      * @brief Set the access log options, records are queued on the logger, see lime::access_logfile().
+      * @param options Options.
+      */
+      Server& access_log(const AccessLog& options);
+
+      /*
+      * @brief Serve the metrics on another port with a thread and worker of their own,
+      *        so scrapes never wait behind other requests. Started and stopped with the server.
+      * @param port Port, 0 lets the system pick a free port which admin_port() returns once started.
+      */
+      Server& admin_port(const uint16_t& port);
+
+      /*
+      * @brief Tag successful responses to GET with a hash of their body when the handler set no ETag,
+      *        requests sending the tag back in If-None-Match get 304 Not Modified. Disabled by default,
+      *        responses with an ETag set by the handler are revalidated either way.
+      * @param enable Enable or disable.
+      */
+      Server& etags(const bool enable);
+
       /*
       * @brief Get server port.
       * @return Server port.
@@ -44,22 +133,170 @@ namespace lime {
       const std::string& addrs() const;
 
       /*
-      * @brief Starts the server.
+      * @brief Get connection timeouts.
+      * @return Timeouts.
+      */
+      [[nodiscard]]
+      const Timeouts& timeouts() const;
+
+      /*
+      * @brief Get request size limits.
+      * @return Limits.
+      */
+      [[nodiscard]]
+      const Limits& limits() const;
+
+      /*
+      * @brief Check if shutdown signals are handled.
+      * @return True if enabled.
+      */
+      [[nodiscard]]
+      bool handle_signals() const;
+
+      /*
+      * @brief Get the access log options.
+      * @return Options.
+      */
+      [[nodiscard]]
+      const AccessLog& access_log() const;
+
+      /*
+      * @brief Get the port metrics are served on.
+      * @return Port, 0 if not enabled.
+      */
+      [[nodiscard]]
+      uint16_t admin_port() const;
+
+      /*
+      * @brief Check if responses are tagged with a hash of their body.
+      * @return True when enabled.
+      */
+      [[nodiscard]]
+      bool etags() const;
+
+      /*
+      * @brief Get the cache of the routes with a policy, see Router::cache(), to resize or clear it.
+      * @return Cache, safe to use from any thread.
+      */
+      [[nodiscard]]
+      ResponseCache& cache();
+
+      /*
+      * @brief Starts the server in the background, returns once it is listening.
+      * @return Returns 0 on success or negative number on error, check errno for more details.
+      */
+      [[nodiscard]]
+      int start();
+
+      /*
+      * @brief Block until a started server stops.
+      * @return Returns 0 on success or negative number on error, check errno for more details.
+      */
+      int wait();
+
+      /*
+      * @brief Starts the server and blocks until it is stopped by stop() or a signal, see handle_signals().
       * @return Returns 0 on success or negative number on error, check errno for more details.
       */
       [[nodiscard]]
       int run();
 
+      /*
+      * @brief Stop accepting clients and wait for requests in progress, up to timeouts().drain.
+      * @return Number of drained and aborted connections.
+      */
+      DrainReport stop();
+
+      /*
+      * @brief Stop accepting clients and wait for requests in progress up to a deadline,
+      *        responses sent meanwhile carry "Connection: close" and connections still busy
+      *        at the deadline are closed. Safe to call from any thread, when called from an
+      *        async handler it only starts the shutdown and returns an empty report.
+      * @param deadline Longest time to wait.
+      * @return Number of drained and aborted connections.
+      */
+      DrainReport stop(std::chrono::milliseconds deadline);
+
     private:
+      /* record false keeps the server and its pool out of the metrics registry */
+      Server(const Router& router, const size_t max_workers, const bool record);
+
+      void accept_clients();
+      void set_phase(const std::shared_ptr<Connection>&, const Phase);
+      void expire(const std::shared_ptr<Connection>&);
+      void wait_request(const std::shared_ptr<Connection>&);
+      void read_request(const std::shared_ptr<Connection>&);
+      [[nodiscard]]
+      bool process(const std::shared_ptr<Connection>&, std::string_view);
+      void dispatch(const std::shared_ptr<Connection>&);
+      void run_handler(const std::shared_ptr<Connection>&);
+      [[nodiscard]]
+      Task<void> dispatch_async(std::shared_ptr<Connection>, const AsyncRouteFunc&);
+      [[nodiscard]]
+      Reply complete(const std::shared_ptr<Connection>&, Response, std::shared_ptr<const CachedResponse>&);
+      [[nodiscard]]
+      Reply cached_reply(const std::shared_ptr<Connection>&, const CachedResponse&);
+      [[nodiscard]]
+      bool serve_cached(const std::shared_ptr<Connection>&);
+      [[nodiscard]]
+      std::shared_ptr<const CachedResponse> store(const std::shared_ptr<Connection>&, Response);
+      void respond_waiting(const std::shared_ptr<Connection>&, Reply, const std::shared_ptr<const CachedResponse>&);
+      void respond(const std::shared_ptr<Connection>&, Reply);
+      void write_response(const std::shared_ptr<Connection>&);
+      void log_access(const std::shared_ptr<Connection>&);
+      void count_request(const std::shared_ptr<Connection>&);
+      void close_connection(std::shared_ptr<Connection>, const bool aborted = false);
+      void stop_accepting();
+      void drain(std::chrono::milliseconds);
+      void abort_drain();
+      void finish_drain();
+
       const Router& m_router;
       uint16_t      m_port;
       int           m_socket;
       sockaddr_in   m_addr;
       socklen_t     m_len;
       std::string   m_addrs;
+      Timeouts      m_timeouts;
+      Limits        m_limits;
+      bool          m_handle_signals = false;
+      bool          m_etags = false;
+      /* false for the admin server, which keeps its traffic out of the metrics */
+      bool          m_record = true;
+      /* used on the loop thread only */
+      AccessLogger  m_access_log;
+      /* looked up on the loop thread, filled by pool workers */
+      ResponseCache m_cache;
+
+      /* serves the metrics route when an admin port is set */
+      std::optional<uint16_t> m_admin_port;
+      std::unique_ptr<Router> m_admin_router;
+      std::unique_ptr<Server> m_admin;
 
+      /* the loop is declared first so pool workers are joined before it is destroyed */
+      EventLoop         m_loop;
       DynamicThreadPool m_pool;
-      std::jthread m_accept_thread;
+
+      /* owned by the loop thread */
+      std::unordered_map<int, std::shared_ptr<Connection>> m_connections;
+      /* request counters of each route by status class, null for requests no route matched */
+      std::unordered_map<const Route*, std::array<metrics::Counter*, 5>> m_requests;
+      /* keys of cached routes whose handler is running, with the requests waiting for its response */
+      std::unordered_map<std::string, std::vector<std::shared_ptr<Connection>>> m_filling;
+      int                m_signal_fd = -1;
+      EventLoop::TimerId m_drain_timer = 0;
+      bool               m_loop_stopping = false;
+      std::atomic<bool>  m_draining = false;
+
+      /* guarded by m_state_mutex, m_report is only read once the server stopped */
+      std::mutex              m_state_mutex;
+      std::condition_variable m_state_changed;
+      bool                    m_running = false;
+      int                     m_result = 0;
+      DrainReport             m_report;
+
+      /* declared last so it is joined before anything it uses is destroyed */
+      std::jthread m_loop_thread;
     };
   } // http
 } // lime
@@ -0,0 +1,353 @@
+#ifndef LIME_JSON_BIND_H
+#define LIME_JSON_BIND_H
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "json.h"
+#include "reader.h"
+#include "writer.h"
+
+/*
+* Bind the members of a struct to the keys of a json object with the same names,
+* used at namespace scope next to the struct:
+*
+*   struct Item { std::string sku; int64_t qty; std::optional<double> price; };
+*   LIME_JSON_FIELDS(Item, sku, qty, price)
+*
+* Members can be integers, floating points, bool, std::string, std::vector and
+* std::optional of those or other bound structs. Optional members are left out
+* when empty and may be missing while decoding, every other member is required.
+*/
+#define LIME_JSON_FIELDS(Type, ...) \
+  [[maybe_unused]] inline constexpr auto lime_json_fields(const Type*) { \
+    return std::make_tuple(LIME_JSON_FOR_EACH(LIME_JSON_FIELD, Type, __VA_ARGS__)); \
+  }
+
+#define LIME_JSON_FIELD(Type, name) ::lime::json::detail::field(#name, &Type::name)
+
+/* rescans the arguments 4^4 times, enough for 256 fields */
+#define LIME_JSON_PARENS ()
+#define LIME_JSON_EXPAND(...)  LIME_JSON_EXPAND3(LIME_JSON_EXPAND3(LIME_JSON_EXPAND3(LIME_JSON_EXPAND3(__VA_ARGS__))))
+#define LIME_JSON_EXPAND3(...) LIME_JSON_EXPAND2(LIME_JSON_EXPAND2(LIME_JSON_EXPAND2(LIME_JSON_EXPAND2(__VA_ARGS__))))
+#define LIME_JSON_EXPAND2(...) LIME_JSON_EXPAND1(LIME_JSON_EXPAND1(LIME_JSON_EXPAND1(LIME_JSON_EXPAND1(__VA_ARGS__))))
+#define LIME_JSON_EXPAND1(...) __VA_ARGS__
+#define LIME_JSON_FOR_EACH(macro, Type, ...) \
+  __VA_OPT__(LIME_JSON_EXPAND(LIME_JSON_FOR_EACH_HELPER(macro, Type, __VA_ARGS__)))
+#define LIME_JSON_FOR_EACH_HELPER(macro, Type, first, ...) \
+  macro(Type, first) __VA_OPT__(, LIME_JSON_FOR_EACH_AGAIN LIME_JSON_PARENS (macro, Type, __VA_ARGS__))
+#define LIME_JSON_FOR_EACH_AGAIN() LIME_JSON_FOR_EACH_HELPER
+
+namespace lime {
+  namespace json {
+    namespace detail {
+      template <typename Class, typename Member>
+      struct Field {
+        std::string_view name;
+        Member Class::* member;
+      };
+
+      template <typename Class, typename Member>
+      constexpr Field<Class, Member> field(std::string_view name, Member Class::* member) {
+        return { name, member };
+      }
+
+      template <typename T>
+      struct is_vector: std::false_type {};
+
+      template <typename T>
+      struct is_vector<std::vector<T>>: std::true_type {};
+
+      template <typename T>
+      struct is_optional: std::false_type {};
+
+      template <typename T>
+      struct is_optional<std::optional<T>>: std::true_type {};
+
+      template <typename>
+      inline constexpr bool unsupported = false;
+    } // detail
+
+    /*
+    * Structs with members bound by LIME_JSON_FIELDS.
+    */
+    template <typename T>
+    concept Bindable = requires(const T* type) {
+      lime_json_fields(type);
+    };
+
+    namespace detail {
+      template <Bindable T>
+      inline constexpr auto fields = lime_json_fields(static_cast<const T*>(nullptr));
+
+      /*
+      * Call fn(field, index) for every bound member of T in declaration order.
+      */
+      template <Bindable T, typename Fn>
+      void each_field(Fn&& fn) {
+        std::apply([&](const auto&... field) {
+          size_t i = 0;
+          (fn(field, i++), ...);
+        }, fields<T>);
+      }
+
+      template <typename T>
+      void write(Writer& writer, const T& value) {
+        if constexpr (Bindable<T>) {
+          writer.begin_object();
+          each_field<T>([&](const auto& field, size_t) {
+            const auto& member = value.*field.member;
+            if constexpr (is_optional<std::remove_cvref_t<decltype(member)>>::value) {
+              if (member.has_value()) {
+                writer.key(field.name);
+                write(writer, *member);
+              }
+            } else {
+              writer.key(field.name);
+              write(writer, member);
+            }
+          });
+          writer.end_object();
+        } else if constexpr (is_vector<T>::value) {
+          writer.begin_array();
+          for (const auto& element: value) {
+            write(writer, element);
+          }
+          writer.end_array();
+        } else if constexpr (std::is_floating_point_v<T>) {
+          writer.value(static_cast<double>(value));
+        } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, bool> || std::is_integral_v<T>) {
+          writer.value(value);
+        } else {
+          static_assert(unsupported<T>, "type can not be bound to json");
+        }
+      }
+
+      /*
+      * State of a decode: the reader and the path of the value being read.
+      */
+      struct Binder {
+        Reader&     reader;
+        std::string path;
+        std::string error;
+
+        bool fail(std::string_view msg) {
+          error = path.empty() ? std::string(msg) : std::format("{}: {}", path, msg);
+          return false;
+        }
+
+        bool mismatch(std::string_view expected, const Event& event) {
+          switch (event) {
+            case Event::Error:       error = reader.error(); return false;
+            case Event::StartObject: return fail(std::format("expected {}, got object", expected));
+            case Event::StartArray:  return fail(std::format("expected {}, got array", expected));
+            case Event::Value:       return fail(std::format("expected {}, got {}", expected, to_string(reader.type())));
+            default:                 return fail(std::format("expected {}, got {}", expected, to_string(event)));
+          }
+        }
+      };
+
+      /*
+      * Read a value whose first event has already been read.
+      */
+      template <typename T>
+      bool read(Binder& binder, T& out, const Event& event) {
+        Reader& reader = binder.reader;
+
+        if constexpr (Bindable<T>) {
+          if (event != Event::StartObject) {
+            return binder.mismatch("object", event);
+          }
+
+          constexpr size_t count = std::tuple_size_v<std::remove_cvref_t<decltype(fields<T>)>>;
+          std::array<bool, count> seen {};
+          const size_t length = binder.path.size();
+
+          while (true) {
+            const auto next = reader.next();
+            if (next == Event::EndObject) {
+              break;
+            }
+
+            if (next != Event::Key) {
+              return binder.mismatch("key", next);
+            }
+
+            const auto key = reader.key();
+            bool found = false, repeated = false, ok = true;
+
+            each_field<T>([&](const auto& field, size_t i) {
+              if (found || field.name != key) {
+                return;
+              }
+
+              found = true;
+              if (seen[i]) {
+                repeated = true;
+                return;
+              }
+
+              seen[i] = true;
+              binder.path += length == 0 ? "" : ".";
+              binder.path += field.name;
+              ok = read(binder, out.*field.member, reader.next());
+            });
+
+            if (!ok) {
+              return false;
+            }
+
+            if (found && !repeated) {
+              binder.path.resize(length);
+              continue;
+            }
+
+            // unknown keys are skipped with whatever value they have, like repeated ones as the first wins
+            const auto value = reader.next();
+            if (value == Event::StartObject || value == Event::StartArray) {
+              reader.skip();
+              if (const auto end = reader.next(); end != Event::EndObject && end != Event::EndArray) {
+                return binder.mismatch("value", end);
+              }
+            } else if (value != Event::Value) {
+              return binder.mismatch("value", value);
+            }
+          }
+
+          bool ok = true;
+          each_field<T>([&](const auto& field, size_t i) {
+            using Member = std::remove_cvref_t<decltype(out.*field.member)>;
+            if (ok && !seen[i] && !is_optional<Member>::value) {
+              ok = binder.fail(std::format("missing field '{}'", field.name));
+            }
+          });
+
+          return ok;
+        } else if constexpr (is_optional<T>::value) {
+          return read(binder, out.emplace(), event);
+        } else if constexpr (is_vector<T>::value) {
+          if (event != Event::StartArray) {
+            return binder.mismatch("array", event);
+          }
+
+          out.clear();
+          const size_t length = binder.path.size();
+
+          while (true) {
+            const auto next = reader.next();
+            if (next == Event::EndArray) {
+              break;
+            }
+
+            binder.path += std::format("[{}]", out.size());
+            if (!read(binder, out.emplace_back(), next)) {
+              return false;
+            }
+            binder.path.resize(length);
+          }
+
+          return true;
+        } else if constexpr (std::is_same_v<T, bool>) {
+          if (event != Event::Value || reader.type() != NodeType::Bool) {
+            return binder.mismatch("bool", event);
+          }
+
+          out = reader.get<bool>();
+          return true;
+        } else if constexpr (std::is_integral_v<T>) {
+          if (event != Event::Value || reader.type() != NodeType::Int) {
+            return binder.mismatch("int", event);
+          }
+
+          const auto value = reader.get<int64_t>();
+          if (!std::in_range<T>(value)) {
+            return binder.fail(std::format("{} is out of range", value));
+          }
+
+          out = static_cast<T>(value);
+          return true;
+        } else if constexpr (std::is_floating_point_v<T>) {
+          if (event != Event::Value || (reader.type() != NodeType::Float && reader.type() != NodeType::Int)) {
+            return binder.mismatch("float", event);
+          }
+
+          out = reader.type() == NodeType::Int
+            ? static_cast<T>(reader.get<int64_t>())
+            : static_cast<T>(reader.get<double>());
+          return true;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+          if (event != Event::Value || reader.type() != NodeType::String) {
+            return binder.mismatch("string", event);
+          }
+
+          out = reader.get<std::string_view>();
+          return true;
+        } else {
+          static_assert(unsupported<T>, "type can not be bound to json");
+        }
+      }
+    } // detail
+
+    /*
+    * @brief Append a bound struct to a buffer as json.
+    * @param value Struct.
+    * @param out Buffer to append to.
+    */
+    template <Bindable T>
+    void encode(const T& value, std::string& out) {
+      Writer writer { out };
+      detail::write(writer, value);
+    }
+
+    /*
+    * @brief Encode a bound struct to json.
+    * @param value Struct.
+    * @return Json string.
+    */
+    template <Bindable T>
+    [[nodiscard]]
+    std::string encode(const T& value) {
+      std::string out {};
+      encode(value, out);
+      return out;
+    }
+
+    /*
+    * @brief Parse a json document straight into a bound struct without building Nodes,
+    *        unknown keys are skipped.
+    * @param data Json string.
+    * @return T or an error naming the path of the offending value,
+    *         e.g. "items[2].qty: expected int, got string".
+    */
+    template <Bindable T>
+    [[nodiscard]]
+    std::expected<T, std::string> decode(std::string_view data) {
+      static_assert(std::is_default_constructible_v<T>, "bound structs have to be default constructible");
+
+      Reader reader { data };
+      detail::Binder binder { reader, {}, {} };
+      T value {};
+
+      if (!detail::read(binder, value, reader.next())) {
+        return std::unexpected(binder.error);
+      }
+
+      if (const auto event = reader.next(); event != Event::End) {
+        return std::unexpected(event == Event::Error ? reader.error() : "expected end of file");
+      }
+
+      return value;
+    }
+  } // json
+} // lime
+
+#endif // LIME_JSON_BIND_H
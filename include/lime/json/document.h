@@ -0,0 +1,231 @@
+#ifndef LIME_JSON_DOCUMENT_H
+#define LIME_JSON_DOCUMENT_H
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "json.h"
+
+namespace lime {
+  namespace json {
+    class Document;
+
+    /*
+    * Read only view of a value inside a Document, cheap to copy
+    * and valid as long as the document is neither moved nor destroyed.
+    */
+    class Value {
+    public:
+      class Iterator;
+      class MemberIterator;
+      struct Member;
+
+      template <typename I>
+      struct Range {
+        I first;
+        I last;
+
+        [[nodiscard]]
+        I begin() const { return first; }
+        [[nodiscard]]
+        I end() const { return last; }
+      };
+
+      /*
+      * @brief Get the Type of the Value.
+      * @return NodeType.
+      */
+      [[nodiscard]]
+      NodeType type() const;
+
+      /*
+      * @brief Get the data of the requested type: int64_t, double, bool or std::string_view.
+      *        Strings point into the parsed input unless they contain escape sequences,
+      *        those are unescaped on first access and kept by the document.
+      * @return T, throws std::bad_variant_access on a type mismatch.
+      */
+      template <typename T>
+      [[nodiscard]]
+      T get() const;
+
+      /*
+      * @brief Get the number of elements of an array or members of an object.
+      * @return Size, 0 for other types.
+      */
+      [[nodiscard]]
+      size_t size() const;
+
+      /*
+      * @brief Get an element of an array by walking its siblings, prefer elements() to iterate.
+      * @param i Position.
+      * @return Value, throws std::out_of_range.
+      */
+      [[nodiscard]]
+      Value operator[](size_t i) const;
+
+      /*
+      * @brief Look up a member of an object.
+      * @param key Unescaped key.
+      * @return Value or std::nullopt.
+      */
+      [[nodiscard]]
+      std::optional<Value> find(std::string_view key) const;
+
+      /*
+      * @brief Check if an object has a member.
+      * @param key Unescaped key.
+      * @return True if found.
+      */
+      [[nodiscard]]
+      bool contains(std::string_view key) const;
+
+      /*
+      * @brief Get a member of an object.
+      * @param key Unescaped key.
+      * @return Value, throws std::out_of_range.
+      */
+      [[nodiscard]]
+      Value at(std::string_view key) const;
+
+      /*
+      * @brief Iterate the elements of an array.
+      * @return Range of Value.
+      */
+      [[nodiscard]]
+      Range<Iterator> elements() const;
+
+      /*
+      * @brief Iterate the members of an object in document order.
+      * @return Range of Member.
+      */
+      [[nodiscard]]
+      Range<MemberIterator> members() const;
+
+      /*
+      * @brief Copy the value into an owning Node.
+      * @return Node.
+      */
+      [[nodiscard]]
+      Node to_node() const;
+
+    private:
+      friend class Document;
+
+      Value(const Document*, uint32_t);
+
+      [[nodiscard]]
+      std::string_view string() const;
+      [[nodiscard]]
+      uint32_t next() const;
+
+      const Document* m_doc;
+      uint32_t        m_pos;
+    };
+
+    struct Value::Member {
+      std::string_view key;
+      Value            value;
+    };
+
+    class Value::Iterator {
+    public:
+      Iterator(const Document*, uint32_t);
+      [[nodiscard]]
+      Value operator*() const;
+      Iterator& operator++();
+      [[nodiscard]]
+      bool operator==(const Iterator&) const = default;
+
+    private:
+      const Document* m_doc;
+      uint32_t        m_pos;
+    };
+
+    class Value::MemberIterator {
+    public:
+      MemberIterator(const Document*, uint32_t);
+      [[nodiscard]]
+      Member operator*() const;
+      MemberIterator& operator++();
+      [[nodiscard]]
+      bool operator==(const MemberIterator&) const = default;
+
+    private:
+      const Document* m_doc;
+      uint32_t        m_pos;
+    };
+
+    /*
+    * Parsed json document referencing its input instead of copying it.
+    * All values are stored in a single flat array in document order,
+    * containers record where their last descendant ends so siblings are
+    * reached without visiting children. The input must outlive the document.
+    * Reading escaped strings caches them, so a document must not be read
+    * from several threads at once.
+    */
+    class Document {
+    public:
+      /*
+      * @brief Parse a json document.
+      * @param data Json string, referenced by the document.
+      * @return <Document, String> Document is the parsed value, String is the Error.
+      */
+      [[nodiscard]]
+      static std::expected<Document, std::string> parse(std::string_view data);
+
+      /*
+      * @brief Get the top level value.
+      * @return Value.
+      */
+      [[nodiscard]]
+      Value root() const;
+
+    private:
+      friend class Value;
+      friend class Value::Iterator;
+      friend class Value::MemberIterator;
+      friend class DocumentBuilder;
+
+      struct Element {
+        NodeType type;
+        /* string length or number of elements/members */
+        uint32_t size;
+        union {
+          int64_t  integer;
+          double   floating;
+          bool     boolean;
+          struct {
+            /* offset in the input */
+            uint32_t offset;
+            /* contains escape sequences */
+            bool     escaped;
+          } string;
+          /* position right after the last descendant of a container */
+          uint32_t end;
+        };
+      };
+
+      Document(std::string_view);
+
+      std::string_view     m_data;
+      std::vector<Element> m_elements;
+      mutable std::unordered_map<uint32_t, std::string> m_unescaped;
+    };
+
+    template <>
+    int64_t Value::get<int64_t>() const;
+    template <>
+    double Value::get<double>() const;
+    template <>
+    bool Value::get<bool>() const;
+    template <>
+    std::string_view Value::get<std::string_view>() const;
+  } // json
+} // lime
+
+#endif // LIME_JSON_DOCUMENT_H
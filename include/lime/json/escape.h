@@ -0,0 +1,46 @@
+#ifndef LIME_JSON_ESCAPE_H
+#define LIME_JSON_ESCAPE_H
+
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace lime {
+  namespace json {
+    struct InvalidString {
+      /* offset of the offending byte in the contents */
+      size_t           offset;
+      std::string_view reason;
+    };
+
+    /*
+    * @brief Check the contents of a json string: escape sequences, surrogate pairs,
+    *        UTF-8 and raw control characters.
+    * @param str Contents of a json string without the surrounding quotes.
+    * @return True if the contents have escape sequences or where they are invalid.
+    */
+    [[nodiscard]]
+    std::expected<bool, InvalidString> validate(std::string_view str);
+
+    /*
+    * @brief Decode the escape sequences of a json string, \uXXXX and surrogate pairs
+    *        are written as UTF-8. Contents that do not pass validate() are decoded
+    *        leniently: unknown sequences are kept and unpaired surrogates become U+FFFD.
+    * @param str Contents of a json string without the surrounding quotes.
+    * @return Unescaped string.
+    */
+    [[nodiscard]]
+    std::string unescape(std::string_view str);
+
+    /*
+    * @brief Append a string to a buffer as a quoted json string, escaping quotes,
+    *        backslashes and control characters.
+    * @param str String.
+    * @param out Buffer to append to.
+    */
+    void escape(std::string_view str, std::string& out);
+  } // json
+} // lime
+
+#endif // LIME_JSON_ESCAPE_H
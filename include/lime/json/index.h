@@ -0,0 +1,120 @@
+#ifndef LIME_JSON_INDEX_H
+#define LIME_JSON_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace lime {
+  namespace json {
+    /*
+    * Instruction sets the structural index can be built with.
+    */
+    enum class Isa {
+      Scalar,
+      SSE42,
+      AVX2,
+    };
+
+    [[nodiscard]]
+    std::string to_string(const Isa&);
+
+    /*
+    * @brief Get the fastest instruction set supported by the running cpu.
+    * @return Isa.
+    */
+    [[nodiscard]]
+    Isa best_isa();
+
+    /*
+    * @brief Check if the running cpu supports an instruction set.
+    * @param isa Instruction set.
+    * @return True if StructuralIndex can be built with it.
+    */
+    [[nodiscard]]
+    bool supported(const Isa& isa);
+
+    /*
+    * @brief Find the first byte that has to be escaped in a json string:
+    *        a quote, a backslash or a control character.
+    * @param data String.
+    * @param isa Instruction set to use.
+    * @return Offset of the byte or data.size() if the string is clean.
+    */
+    [[nodiscard]]
+    size_t find_escape(std::string_view data, const Isa& isa = best_isa());
+
+    /*
+    * @brief Find the first byte of json string contents that has to be looked at
+    *        while reading them: a quote, a backslash, a control character or
+    *        a byte of a multi-byte UTF-8 sequence.
+    * @param data String contents.
+    * @param isa Instruction set to use.
+    * @return Offset of the byte or data.size() if the contents are plain ASCII.
+    */
+    [[nodiscard]]
+    size_t find_special(std::string_view data, const Isa& isa = best_isa());
+
+    /*
+    * Positions of every token start in a json document, found 64 bytes
+    * at a time before parsing: structural characters outside of strings,
+    * both quotes of every string and the first byte of every other literal.
+    */
+    class StructuralIndex {
+    public:
+      /*
+      * @brief Index a document, unsupported instruction sets fall back to Isa::Scalar.
+      * @param data Document, must outlive the index and be smaller than 4 GiB.
+      * @param isa Instruction set to use.
+      */
+      explicit StructuralIndex(std::string_view data, const Isa& isa = best_isa());
+
+      /*
+      * @brief Get the number of indexed positions.
+      * @return Size.
+      */
+      [[nodiscard]]
+      size_t size() const;
+
+      /*
+      * @brief Get an indexed position.
+      * @param i Index, must be less than size().
+      * @return Offset into the document.
+      */
+      [[nodiscard]]
+      uint32_t operator[](size_t i) const;
+
+      /*
+      * @brief Check if the last string of the document is missing its closing quote.
+      * @return True if unterminated.
+      */
+      [[nodiscard]]
+      bool unterminated() const;
+
+      /*
+      * @brief Get the offset of the first raw newline inside a string.
+      * @return Offset or std::string_view::npos.
+      */
+      [[nodiscard]]
+      size_t string_newline() const;
+
+    private:
+      std::unique_ptr<uint32_t[]> m_positions;
+      size_t m_size = 0;
+      size_t m_string_newline = std::string_view::npos;
+      bool   m_unterminated = false;
+    };
+
+    inline size_t StructuralIndex::size() const {
+      return m_size;
+    }
+
+    inline uint32_t StructuralIndex::operator[](size_t i) const {
+      return m_positions[i];
+    }
+  } // json
+} // lime
+
+#endif // LIME_JSON_INDEX_H
@@ -3,11 +3,24 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <expected>
 #include <vector>
 #include <unordered_map>
 #include <variant>
 
+#include "object.h"
+
+#ifndef JSON_ORDERED_OBJECT
+  /*
+  * 1 makes json::Object a json::OrderedObject keeping insertion order instead
+  * of a std::unordered_map. It changes the layout of json::Node, so the
+  * library and its users have to be built with the same value, a mismatch
+  * fails to link.
+  */
+  #define JSON_ORDERED_OBJECT 0
+#endif
+
 namespace lime {
   namespace json {
     class Node;
@@ -25,7 +38,23 @@ namespace lime {
     std::string to_string(const NodeType&);
 
     using Array = std::vector<Node>;
+#if JSON_ORDERED_OBJECT
+    using Object = OrderedObject;
+#else
     using Object = std::unordered_map<std::string, Node>;
+#endif
+
+    namespace abi {
+      /* defined by the library only for the value it was built with */
+#if JSON_ORDERED_OBJECT
+      int ordered_object();
+      inline const int object { ordered_object() };
+#else
+      int unordered_object();
+      inline const int object { unordered_object() };
+#endif
+    } // abi
+
     using Data = std::variant<
       int64_t,
       double,
@@ -40,6 +69,10 @@ namespace lime {
       // to keep backwards compatibility
       // Node constructor with int is left out
       // as an option
+      /*
+      * @brief Construct an empty object Node.
+      */
+      Node();
       Node(const int&);
       Node(const int64_t&);
       Node(const double&);
@@ -86,6 +119,16 @@ namespace lime {
       [[nodiscard]]
       const T& get() const;
 
+      /*
+      * @brief Look up a value with a JSON Pointer (RFC 6901) like "/items/0/sku".
+      * @param pointer Pointer, "" is the node itself.
+      * @return Node or nullptr if the pointer is invalid or does not resolve.
+      */
+      [[nodiscard]]
+      const Node* at_pointer(std::string_view pointer) const;
+      [[nodiscard]]
+      Node* at_pointer(std::string_view pointer);
+
       /*
       * @brief Converts a node to equivalent json string.
       * @return Json String format of the node.
@@ -115,6 +158,14 @@ namespace lime {
     [[nodiscard]]
     std::string encode(const Node&);
 
+    /*
+    * @brief Append the json String of the given Node to a buffer,
+    *        clearing and reusing the buffer avoids allocating per call.
+    * @param node Node.
+    * @param out Buffer to append to.
+    */
+    void encode(const Node& node, std::string& out);
+
     /*
     * @brief Decode the given json string to equivalent json Node.
     * @return <Node, String> Node the the Value, String is the Error.
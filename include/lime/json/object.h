@@ -0,0 +1,142 @@
+#ifndef LIME_JSON_OBJECT_H
+#define LIME_JSON_OBJECT_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifndef JSON_OBJECT_LINEAR_SIZE
+  /* members of a json::OrderedObject searched linearly before it builds a hash index */
+  #define JSON_OBJECT_LINEAR_SIZE 16
+#endif
+
+namespace lime {
+  namespace json {
+    class Node;
+
+    /*
+    * Json object keeping its members in insertion order in one flat vector.
+    * Small objects are searched linearly, larger ones build a hash index of
+    * member positions as they grow. Offers the parts of the std::unordered_map
+    * interface json objects are used with, but like a std::vector inserting
+    * may move the members, so references and iterators to them are only
+    * valid until the next insert or erase.
+    */
+    class OrderedObject {
+    public:
+      using key_type = std::string;
+      using mapped_type = Node;
+      using value_type = std::pair<const std::string, Node>;
+      using size_type = size_t;
+      using iterator = std::vector<value_type>::iterator;
+      using const_iterator = std::vector<value_type>::const_iterator;
+
+      OrderedObject();
+      OrderedObject(std::initializer_list<value_type> members);
+
+      [[nodiscard]]
+      iterator begin();
+      [[nodiscard]]
+      iterator end();
+      [[nodiscard]]
+      const_iterator begin() const;
+      [[nodiscard]]
+      const_iterator end() const;
+
+      [[nodiscard]]
+      size_t size() const;
+      [[nodiscard]]
+      bool empty() const;
+      void clear();
+      void reserve(size_t size);
+
+      /*
+      * @brief Find a member by key.
+      * @param key Key.
+      * @return Iterator to the member or end().
+      */
+      [[nodiscard]]
+      iterator find(std::string_view key);
+      [[nodiscard]]
+      const_iterator find(std::string_view key) const;
+
+      [[nodiscard]]
+      bool contains(std::string_view key) const;
+      [[nodiscard]]
+      size_t count(std::string_view key) const;
+
+      /*
+      * @brief Get the value of a member.
+      * @param key Key.
+      * @return Node, throws std::out_of_range if the key is missing.
+      */
+      [[nodiscard]]
+      Node& at(std::string_view key);
+      [[nodiscard]]
+      const Node& at(std::string_view key) const;
+
+      /*
+      * @brief Append a member unless the key is already present.
+      * @param member Key and value.
+      * @return Iterator to the member with the key and true if it was inserted.
+      */
+      std::pair<iterator, bool> insert(const value_type& member);
+      std::pair<iterator, bool> insert(value_type&& member);
+
+      /*
+      * @brief Append a member built from a key and a value unless the key is already present.
+      * @param key Key.
+      * @param value Value.
+      * @return Iterator to the member with the key and true if it was inserted.
+      */
+      template <typename Key, typename Value>
+      std::pair<iterator, bool> emplace(Key&& key, Value&& value);
+
+      /*
+      * @brief Get the value of a member, appending an empty object under the key if it is missing.
+      * @param key Key.
+      * @return Node.
+      */
+      [[nodiscard]]
+      Node& operator[](std::string_view key);
+
+      /*
+      * @brief Append a member or replace the value of an existing one in place.
+      * @param key Key.
+      * @param value Value.
+      * @return Iterator to the member and true if it was inserted.
+      */
+      std::pair<iterator, bool> insert_or_assign(std::string key, Node value);
+
+      /*
+      * @brief Remove a member keeping the order of the others.
+      * @param key Key.
+      * @return Number of members removed.
+      */
+      size_t erase(std::string_view key);
+      iterator erase(const_iterator pos);
+
+    private:
+      std::pair<iterator, bool> append(std::string&& key, Node&& value);
+      void reallocate(size_t capacity, const_iterator skip);
+      [[nodiscard]]
+      size_t position(std::string_view key) const;
+      void index(size_t pos);
+      void reindex();
+
+      std::vector<value_type> m_members;
+      /* open addressing table of member positions + 1, empty while the object is small */
+      std::vector<uint32_t>   m_slots;
+    };
+
+    template <typename Key, typename Value>
+    inline std::pair<OrderedObject::iterator, bool> OrderedObject::emplace(Key&& key, Value&& value) {
+      return append(std::string(std::forward<Key>(key)), Node(std::forward<Value>(value)));
+    }
+  } // json
+} // lime
+
+#endif // LIME_JSON_OBJECT_H
@@ -2,9 +2,11 @@
 #define LIME_JSON_PARSER_H
 
 #include <string>
+#include <string_view>
 #include <variant>
 #include <cstdint>
 
+#include "index.h"
 #include "json.h"
 
 namespace lime {
@@ -34,32 +36,61 @@ namespace lime {
       size_t lnbeg = 0;
     };
 
+    /*
+    * Tokenizer walking the structural index of a document
+    * instead of its bytes, whitespace is never visited.
+    */
     class Scanner {
     public:
-      Scanner(const std::string&);
+      Scanner(std::string_view, const Isa& isa = best_isa());
       template <typename T>
       [[nodiscard]]
       T& get();
       [[nodiscard]]
       std::expected<Token, std::string> token();
       [[nodiscard]]
-      const ScannerLocation& location() const;
+      ScannerLocation location() const;
+      /* upper bound on the number of tokens left */
+      [[nodiscard]]
+      size_t remaining() const;
+      /* offset right after the last complete token */
+      [[nodiscard]]
+      size_t consumed() const;
+      /* offset of the first byte of the last token */
+      [[nodiscard]]
+      size_t cursor() const;
+      /* the last token reached the end of the data and may continue in more input */
+      [[nodiscard]]
+      bool partial() const;
+      /* first byte of the next token without reading it, '\0' at the end */
+      [[nodiscard]]
+      char peek() const;
+      /* skip the rest of the object or array just opened, only brackets are matched */
+      [[nodiscard]]
+      bool skip();
+      /* the last string has escape sequences and has to be unescaped */
+      [[nodiscard]]
+      bool escaped() const;
 
     private:
-      void forward();
       [[nodiscard]]
-      bool is_end() const;
+      bool is_delimiter(size_t) const;
       [[nodiscard]]
-      bool skip_whitespaces();
+      std::expected<Token, std::string> string();
       [[nodiscard]]
-      char curr_char() const;
+      std::expected<Token, std::string> literal();
       [[nodiscard]]
-      char peek_char() const;
+      std::expected<Token, std::string> number();
 
-      std::variant<int64_t, double, bool, std::string> m_value;
-      const std::string& m_data;
-      ScannerLocation    m_loc;
-      ScannerLocation    m_lastloc;
+      /* strings are views into the document */
+      std::variant<int64_t, double, bool, std::string_view> m_value;
+      std::string_view   m_data;
+      StructuralIndex    m_index;
+      size_t             m_next = 0;
+      size_t             m_cursor = 0;
+      size_t             m_consumed = 0;
+      bool               m_partial = false;
+      bool               m_escaped = false;
     };
 
     template <typename T>
@@ -67,6 +98,9 @@ namespace lime {
       return std::get<T>(m_value);
     }
 
+    [[nodiscard]]
+    std::unexpected<std::string> fmterror(const std::string&, const ScannerLocation&);
+
     class Parser {
     public:
       Parser(Scanner&);
@@ -80,9 +114,13 @@ namespace lime {
       std::expected<Node, std::string> array();
       [[nodiscard]]
       std::expected<Node, std::string> literal();
+      [[nodiscard]]
+      std::string string() const;
 
       Scanner& m_sc;
       Token    m_token;
+      /* arrays and objects open around the current token */
+      size_t   m_depth = 0;
     };
   } // json
 } // lime
@@ -0,0 +1,38 @@
+#ifndef LIME_JSON_POINTER_H
+#define LIME_JSON_POINTER_H
+
+#include <expected>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.h"
+
+namespace lime {
+  namespace json {
+    /*
+    * @brief Pull a few values out of a document with JSON Pointers (RFC 6901) in one pass.
+    *        Only the requested values become Nodes, every other object or array is
+    *        skipped by matching brackets without being parsed, and scanning stops
+    *        once every pointer is resolved.
+    * @param data Json string.
+    * @param pointers Pointers like "/user/id" or "/items/0/sku".
+    * @return A value per pointer in the same order, std::nullopt for the ones that
+    *         do not resolve, or an error for an invalid pointer or document.
+    */
+    [[nodiscard]]
+    std::expected<std::vector<std::optional<Node>>, std::string>
+    extract(std::string_view data, std::span<const std::string_view> pointers);
+
+    [[nodiscard]]
+    inline std::expected<std::vector<std::optional<Node>>, std::string>
+    extract(std::string_view data, std::initializer_list<std::string_view> pointers) {
+      return extract(data, std::span { pointers.begin(), pointers.size() });
+    }
+  } // json
+} // lime
+
+#endif // LIME_JSON_POINTER_H
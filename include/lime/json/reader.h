@@ -0,0 +1,182 @@
+#ifndef LIME_JSON_READER_H
+#define LIME_JSON_READER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "json.h"
+
+#ifndef JSON_READER_MAX_DEPTH
+  /* deepest nesting accepted by json::Reader, json::Document and json::decode, bounds their memory and stack */
+  #define JSON_READER_MAX_DEPTH 512
+#endif
+
+namespace lime {
+  namespace json {
+    class Scanner;
+
+    enum class Event {
+      /* the input fed so far ends in the middle of the document */
+      NeedMore,
+      StartObject,
+      EndObject,
+      StartArray,
+      EndArray,
+      Key,
+      Value,
+      /* the document is complete */
+      End,
+      Error,
+    };
+
+    [[nodiscard]]
+    std::string to_string(const Event&);
+
+    /*
+    * Pull based json reader fed with chunks of a document as they arrive.
+    * Only the bytes of a token split between two chunks are kept around,
+    * so memory depends on the nesting depth and not on the document size
+    * as long as more input is fed only when next() asks for it.
+    */
+    class Reader {
+    public:
+      Reader();
+
+      /*
+      * @brief Read a complete document in place without copying it, feed() must not be called.
+      * @param document Json string, must outlive the reader.
+      */
+      explicit Reader(std::string_view document);
+
+      ~Reader();
+
+      Reader(Reader&&) noexcept;
+      Reader& operator=(Reader&&) noexcept;
+
+      /*
+      * @brief Append the next chunk of the document, invalidates keys and values read so far.
+      * @param chunk Bytes of the document.
+      */
+      void feed(std::string_view chunk);
+
+      /*
+      * @brief Mark the end of the input, tokens left at the end are completed.
+      */
+      void finish();
+
+      /*
+      * @brief Read the next event.
+      * @return Event, Event::NeedMore until more input is fed or finish() is called.
+      */
+      [[nodiscard]]
+      Event next();
+
+      /*
+      * @brief Skip the rest of the object or array just started, next() continues after its end.
+      */
+      void skip();
+
+      /*
+      * @brief Get the unescaped key, valid after Event::Key.
+      * @return Key.
+      */
+      [[nodiscard]]
+      std::string_view key() const;
+
+      /*
+      * @brief Get the type of the value, valid after Event::Value.
+      * @return NodeType.
+      */
+      [[nodiscard]]
+      NodeType type() const;
+
+      /*
+      * @brief Get the value of the requested type: int64_t, double, bool or std::string_view.
+      * @return T, throws std::bad_variant_access on a type mismatch.
+      */
+      template <typename T>
+      [[nodiscard]]
+      T get() const;
+
+      /*
+      * @brief Get the number of objects and arrays currently open.
+      * @return Depth.
+      */
+      [[nodiscard]]
+      size_t depth() const;
+
+      /*
+      * @brief Get the error message, valid after Event::Error.
+      * @return Error.
+      */
+      [[nodiscard]]
+      const std::string& error() const;
+
+    private:
+      enum class Expect {
+        Value,
+        ValueOrEnd,
+        Key,
+        KeyOrEnd,
+        Colon,
+        CommaOrEnd,
+        Done,
+      };
+
+      [[nodiscard]]
+      Event step();
+      [[nodiscard]]
+      Event fail(const std::string&);
+      [[nodiscard]]
+      Event close(const NodeType&);
+      [[nodiscard]]
+      static std::string_view unescaped(std::string_view, bool, std::string&);
+      [[nodiscard]]
+      bool token_end();
+      void drop();
+
+      std::string              m_buffer;
+      /* the complete document when reading in place */
+      std::string_view         m_document;
+      std::unique_ptr<Scanner> m_scanner;
+      bool                     m_finished = false;
+      bool                     m_need_more = false;
+      bool                     m_in_place = false;
+
+      /*
+      * a token split between chunks is scanned again only once its end has
+      * arrived, new input is searched for it from here, npos when no token is split
+      */
+      size_t m_search = std::string::npos;
+      bool   m_search_string = false;
+      /* the input so far ends with a backslash escaping the next byte of the string */
+      bool   m_search_escape = false;
+
+      Expect                m_expect = Expect::Value;
+      std::vector<NodeType> m_stack;
+      size_t                m_skip = 0;
+      bool                  m_skipping = false;
+
+      std::variant<int64_t, double, bool, std::string_view> m_value;
+      std::string_view m_key;
+      std::string      m_unescaped_key;
+      std::string      m_unescaped_value;
+      std::string      m_error;
+
+      /* position of the buffer in the document, for error messages */
+      size_t m_row = 0;
+      size_t m_column = 0;
+    };
+
+    template <typename T>
+    inline T Reader::get() const {
+      return std::get<T>(m_value);
+    }
+  } // json
+} // lime
+
+#endif // LIME_JSON_READER_H
@@ -0,0 +1,111 @@
+#ifndef LIME_JSON_WRITER_H
+#define LIME_JSON_WRITER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "json.h"
+
+#ifndef JSON_WRITER_FLUSH_SIZE
+  /* buffered bytes after which a writer with a sink hands them over */
+  #define JSON_WRITER_FLUSH_SIZE (16 * 1024)
+#endif
+
+namespace lime {
+  namespace json {
+    /*
+    * Streaming json writer appending straight to a buffer without building Nodes.
+    * Calls are expected in document order, debug builds assert on misplaced
+    * keys, values and unbalanced objects or arrays.
+    */
+    class Writer {
+    public:
+      using Sink = std::function<void(std::string_view)>;
+
+      /*
+      * @brief Create a writer appending to a buffer.
+      * @param out Buffer, must outlive the writer.
+      */
+      explicit Writer(std::string& out);
+
+      /*
+      * @brief Create a writer handing its output to a sink in pieces, so large
+      *        documents are never held in memory as a whole.
+      * @param out Buffer, must outlive the writer.
+      * @param sink Called with the buffered bytes whenever they exceed the threshold and on flush().
+      * @param threshold Buffered bytes before the sink is called.
+      */
+      Writer(std::string& out, Sink sink, size_t threshold = JSON_WRITER_FLUSH_SIZE);
+
+      Writer& begin_object();
+      Writer& end_object();
+      Writer& begin_array();
+      Writer& end_array();
+
+      /*
+      * @brief Write the key of the next object member.
+      * @param key Key, escaped as needed.
+      */
+      Writer& key(std::string_view key);
+
+      /*
+      * @brief Write a value as an array element, an object member after key() or the document.
+      * @param value Value.
+      */
+      template <typename T>
+      requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+      Writer& value(T value);
+      Writer& value(double value);
+      Writer& value(bool value);
+      Writer& value(std::string_view value);
+      Writer& value(const char* value);
+      Writer& value(const std::string& value);
+      Writer& value(const Node& value);
+
+      /*
+      * @brief Hand the buffered output to the sink, does nothing without one.
+      */
+      void flush();
+
+      /*
+      * @brief Check if a whole document has been written.
+      * @return True once the top level value is complete.
+      */
+      [[nodiscard]]
+      bool complete() const;
+
+    private:
+      Writer& integer(int64_t);
+      Writer& integer(uint64_t);
+      [[nodiscard]]
+      bool expects_value() const;
+      void separate();
+      void written();
+
+      std::string&      m_out;
+      Sink              m_sink;
+      size_t            m_threshold = 0;
+      /* true for objects, false for arrays */
+      std::vector<bool> m_stack;
+      bool              m_first = true;
+      bool              m_after_key = false;
+      bool              m_complete = false;
+    };
+
+    template <typename T>
+    requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    inline Writer& Writer::value(T value) {
+      if constexpr (std::is_signed_v<T>) {
+        return integer(static_cast<int64_t>(value));
+      } else {
+        return integer(static_cast<uint64_t>(value));
+      }
+    }
+  } // json
+} // lime
+
+#endif // LIME_JSON_WRITER_H
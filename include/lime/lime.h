@@ -16,9 +16,20 @@
 #ifndef LIME_H
 #define LIME_H
 
+#include "async/eventloop.h"
+#include "async/task.h"
+#include "async/timerwheel.h"
 #include "http/http.h"
+#include "json/bind.h"
+#include "json/document.h"
 #include "json/json.h"
+#include "json/pointer.h"
+#include "json/reader.h"
+#include "json/writer.h"
+#include "metrics/metrics.h"
+#include "metrics/prometheus.h"
 #include "threadpool/threadpool.h"
+#include "trace/trace.h"
 #include "utils/logger.h"
 
 namespace lime {
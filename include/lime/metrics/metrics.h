@@ -0,0 +1,226 @@
+#ifndef LIME_METRICS_METRICS_H
+#define LIME_METRICS_METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef METRICS_SHARDS
+  /* slots counters and histograms are split into, each thread records into one */
+  #define METRICS_SHARDS 16
+#endif
+
+namespace lime {
+  namespace metrics {
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    namespace shard {
+      /* assigned round robin the first time a thread records */
+      [[nodiscard]]
+      size_t assign();
+
+      [[nodiscard]]
+      inline size_t current() {
+        thread_local const size_t index { assign() };
+        return index;
+      }
+    } // shard
+
+    /*
+    * Monotonic counter. Every thread adds to its own cache line, the shards
+    * are only summed when the value is read.
+    */
+    class Counter {
+    public:
+      void add(uint64_t n = 1) {
+        m_shards[shard::current()].value.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      [[nodiscard]]
+      uint64_t value() const;
+
+    private:
+      struct alignas(64) Shard {
+        std::atomic<uint64_t> value { 0 };
+      };
+
+      std::array<Shard, METRICS_SHARDS> m_shards;
+    };
+
+    /* value going up and down, like connections in use */
+    class Gauge {
+    public:
+      void add(int64_t n = 1) {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      void sub(int64_t n = 1) {
+        m_value.fetch_sub(n, std::memory_order_relaxed);
+      }
+
+      void set(int64_t value) {
+        m_value.store(value, std::memory_order_relaxed);
+      }
+
+      [[nodiscard]]
+      int64_t value() const {
+        return m_value.load(std::memory_order_relaxed);
+      }
+
+    private:
+      std::atomic<int64_t> m_value { 0 };
+    };
+
+    /*
+    * Histogram with logarithmic buckets split linearly in 8, so a bucket is
+    * at most 12.5% wide relative to its values. Values below 8 get a bucket
+    * each, values from 2^40 on share the last one.
+    */
+    class Histogram {
+    public:
+      static constexpr size_t SubBits { 3 };
+      static constexpr size_t MaxBits { 40 };
+      static constexpr size_t Buckets { (MaxBits - SubBits + 1) << SubBits };
+
+      struct Snapshot {
+        std::array<uint64_t, Buckets> counts {};
+        uint64_t                      count = 0;
+        uint64_t                      sum = 0;
+
+        /*
+        * @brief Estimate a quantile.
+        * @param q Quantile from 0 to 1.
+        * @return Upper bound of the bucket the quantile falls in, 0 when empty.
+        */
+        [[nodiscard]]
+        uint64_t quantile(double q) const;
+      };
+
+      void record(uint64_t value) {
+        Shard& shard { m_shards[shard::current()] };
+        shard.counts[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+      }
+
+      /* durations are recorded in nanoseconds */
+      void record(std::chrono::nanoseconds duration) {
+        record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+      }
+
+      /*
+      * @brief Sum the shards.
+      * @return Counts of every bucket, their total and the sum of the values.
+      */
+      [[nodiscard]]
+      Snapshot snapshot() const;
+
+      [[nodiscard]]
+      static constexpr size_t bucket(uint64_t value) {
+        if (value < (1 << SubBits)) {
+          return static_cast<size_t>(value);
+        }
+
+        const size_t msb { static_cast<size_t>(std::bit_width(value)) - 1 };
+        if (msb >= MaxBits) {
+          return Buckets - 1;
+        }
+
+        const size_t shift { msb - SubBits };
+        return ((msb - SubBits + 1) << SubBits) + static_cast<size_t>((value >> shift) & ((1 << SubBits) - 1));
+      }
+
+      /*
+      * @brief Get the first value above a bucket.
+      * @param bucket Bucket.
+      * @return Exclusive upper bound.
+      */
+      [[nodiscard]]
+      static constexpr uint64_t upper(size_t bucket) {
+        if (bucket < (1 << SubBits)) {
+          return bucket + 1;
+        }
+
+        const size_t shift { (bucket >> SubBits) - 1 };
+        const uint64_t sub { (1 << SubBits) + (bucket & ((1 << SubBits) - 1)) };
+        return (sub + 1) << shift;
+      }
+
+    private:
+      struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, Buckets> counts {};
+        std::atomic<uint64_t>                      sum { 0 };
+      };
+
+      std::array<Shard, METRICS_SHARDS> m_shards;
+    };
+
+    enum class Type {
+      Counter,
+      Gauge,
+      Histogram,
+    };
+
+    struct Metric {
+      std::string name;
+      std::string help;
+      Labels      labels;
+      Type        type;
+      /* multiplier from recorded histogram values to exported ones, 1e-9 for durations in seconds */
+      double      scale = 1.0;
+
+      std::unique_ptr<Counter>   counter;
+      std::unique_ptr<Gauge>     gauge;
+      std::unique_ptr<Histogram> histogram;
+    };
+
+    /*
+    * Named metrics, registering takes a lock but recording into the returned
+    * references never does. Metrics live as long as the registry, asking
+    * for a name and labels again returns the same metric.
+    */
+    class Registry {
+    public:
+      /*
+      * @brief Get or create a counter.
+      * @param name Name like "lime_requests_total".
+      * @param help Description.
+      * @param labels Labels telling apart metrics of the same name.
+      * @return Counter, throws std::invalid_argument if the name is registered with another type.
+      */
+      Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+      Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+      Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = {}, double scale = 1.0);
+
+      /*
+      * @brief Call a function with every metric in the order they were registered.
+      * @param func Function.
+      */
+      void visit(const std::function<void(const Metric&)>& func) const;
+
+    private:
+      Metric& get(const std::string& name, const std::string& help, const Labels& labels, Type type);
+
+      mutable std::mutex m_mutex;
+      std::deque<Metric> m_metrics;
+    };
+
+    /*
+    * @brief Get the registry the server and thread pool record into.
+    * @return Registry.
+    */
+    [[nodiscard]]
+    Registry& registry();
+  } // metrics
+} // lime
+
+#endif // LIME_METRICS_METRICS_H
@@ -0,0 +1,26 @@
+#ifndef LIME_METRICS_PROMETHEUS_H
+#define LIME_METRICS_PROMETHEUS_H
+
+#include <string>
+
+#include "metrics.h"
+
+namespace lime {
+  namespace metrics {
+    inline constexpr auto PrometheusContentType { "text/plain; version=0.0.4; charset=utf-8" };
+
+    /*
+    * @brief Render metrics in the Prometheus text exposition format, shards are
+    *        summed here. Histograms export a bucket per power of two of the
+    *        recorded values, multiplied by their scale.
+    * @param registry Registry.
+    * @param out Buffer to append to.
+    */
+    void prometheus(const Registry& registry, std::string& out);
+
+    [[nodiscard]]
+    std::string prometheus(const Registry& registry);
+  } // metrics
+} // lime
+
+#endif // LIME_METRICS_PROMETHEUS_H
@@ -3,6 +3,7 @@
 
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <mutex>
@@ -10,10 +11,13 @@
 #include <thread>
 #include <queue>
 
+#include "../metrics/metrics.h"
+
 namespace lime {
   class DynamicThreadPool {
   public:
-    explicit DynamicThreadPool(size_t max_workers = std::thread::hardware_concurrency());
+    /* record false leaves the queue metrics alone, for pools of internal servers */
+    explicit DynamicThreadPool(size_t max_workers = std::thread::hardware_concurrency(), bool record = true);
     ~DynamicThreadPool();
     void enqueue(std::function<void()>);
     void shutdown();
@@ -21,11 +25,20 @@ namespace lime {
   private:
     void worker(const size_t id, std::stop_token);
 
+    /* a task and when it was queued, for the queue wait metric */
+    struct Job {
+      std::function<void()>                 func;
+      std::chrono::steady_clock::time_point queued;
+    };
+
+    metrics::Histogram&               m_queue_wait;
+    metrics::Gauge&                   m_queued;
     std::vector<std::jthread>         m_workers;
-    std::queue<std::function<void()>> m_tasks;
+    std::queue<Job>                   m_tasks;
     std::condition_variable           m_task_available;
     std::mutex                        m_tasks_mutex;
     std::atomic<bool>                 m_stop = false;
+    bool                              m_record;
   };
 } // lime
 
@@ -0,0 +1,167 @@
+#ifndef LIME_TRACE_TRACE_H
+#define LIME_TRACE_TRACE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef TRACE_USE_TSC
+  /* read the time stamp counter instead of the system clock where it is invariant */
+  #if defined(__x86_64__) || defined(__i386__)
+    #define TRACE_USE_TSC 1
+  #else
+    #define TRACE_USE_TSC 0
+  #endif
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+  /* requests kept for trace::chrome() when no capacity is given to trace::enable() */
+  #define TRACE_BUFFER_SIZE 4096
+#endif
+
+namespace lime {
+  namespace trace {
+    /* time stamp counter ticks or steady clock nanoseconds, see tsc() */
+    using Ticks = uint64_t;
+
+    /* checked once, the counter must tick at a constant rate on every core */
+    [[nodiscard]]
+    bool invariant_tsc();
+
+    [[nodiscard]]
+    inline bool tsc() {
+    #if TRACE_USE_TSC
+      static const bool res { invariant_tsc() };
+      return res;
+    #else
+      return false;
+    #endif
+    }
+
+    /*
+    * @brief Read the cheapest monotonic clock available.
+    * @return Ticks, only meaningful relative to other ticks.
+    */
+    [[nodiscard]]
+    inline Ticks now() {
+    #if TRACE_USE_TSC
+      if (tsc()) {
+        return __builtin_ia32_rdtsc();
+      }
+    #endif
+      return static_cast<Ticks>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    /*
+    * @brief Convert the ticks between two readings of now().
+    * @param from Earlier reading.
+    * @param to Later reading.
+    * @return Duration, negative if to is earlier.
+    */
+    [[nodiscard]]
+    std::chrono::nanoseconds elapsed(Ticks from, Ticks to);
+
+    /* points in the life of a request, in order */
+    enum class Phase : uint8_t {
+      /* the connection was accepted, only for its first request */
+      Accepted,
+      /* the first byte of the request was read */
+      Started,
+      HeadRead,
+      BodyRead,
+      Routed,
+      HandlerStarted,
+      HandlerFinished,
+      Serialized,
+      Written,
+    };
+
+    inline constexpr size_t Phases { static_cast<size_t>(Phase::Written) + 1 };
+
+    [[nodiscard]]
+    const char* to_string(const Phase& phase);
+
+    class Timings {
+    public:
+      void mark(const Phase& phase) {
+        m_at[static_cast<size_t>(phase)] = now();
+      }
+
+      /*
+      * @brief Get when a phase was reached.
+      * @param phase Phase.
+      * @return Ticks, 0 if it was not reached.
+      */
+      [[nodiscard]]
+      Ticks at(const Phase& phase) const {
+        return m_at[static_cast<size_t>(phase)];
+      }
+
+      [[nodiscard]]
+      bool reached(const Phase& phase) const {
+        return at(phase) != 0;
+      }
+
+      /*
+      * @brief Get the time between two phases.
+      * @param from Phase.
+      * @param to Later phase.
+      * @return Duration, zero if either was not reached.
+      */
+      [[nodiscard]]
+      std::chrono::nanoseconds between(const Phase& from, const Phase& to) const;
+
+      /*
+      * @brief Get the time since a phase.
+      * @param from Phase.
+      * @return Duration, zero if it was not reached.
+      */
+      [[nodiscard]]
+      std::chrono::nanoseconds since(const Phase& from) const;
+
+    private:
+      std::array<Ticks, Phases> m_at {};
+    };
+
+    /* a finished request kept for the trace */
+    struct Span {
+      Timings     timings;
+      /* like "GET /users" */
+      std::string name;
+      int         status;
+      /* connection, requests of one connection share a track */
+      int         track;
+    };
+
+    /*
+    * @brief Start keeping the latest finished requests, servers record them while enabled.
+    * @param capacity Requests kept, older ones are overwritten.
+    */
+    void enable(size_t capacity = TRACE_BUFFER_SIZE);
+    void disable();
+
+    [[nodiscard]]
+    bool enabled();
+
+    /*
+    * @brief Keep a finished request if tracing is enabled.
+    * @param span Request.
+    */
+    void record(Span span);
+
+    /*
+    * @brief Render the kept requests as Chrome trace event json, which chrome://tracing
+    *        and Perfetto open, with an event per request and nested events per phase.
+    * @param out Buffer to append to.
+    */
+    void chrome(std::string& out);
+
+    [[nodiscard]]
+    std::string chrome();
+  } // trace
+} // lime
+
+#endif // LIME_TRACE_TRACE_H
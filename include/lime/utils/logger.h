@@ -1,7 +1,25 @@
 #ifndef LIME_UTILS_LOGGER_H
 #define LIME_UTILS_LOGGER_H
 
+#include <atomic>
+#include <cstddef>
+#include <format>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <utility>
+
+#ifndef LOGGER_MIN_LEVEL
+  /*
+  * lowest LogLevel compiled in, calls below it are removed entirely.
+  * release builds drop debug messages.
+  */
+  #ifdef NDEBUG
+    #define LOGGER_MIN_LEVEL 1
+  #else
+    #define LOGGER_MIN_LEVEL 0
+  #endif
+#endif
 
 namespace lime {
   enum class LogLevel {
@@ -11,11 +29,127 @@ namespace lime {
     None,
   };
 
+  namespace logging {
+    extern std::atomic<LogLevel> level;
+
+    /* queues a message of a level, LogLevel::None is used for errors */
+    void write(const LogLevel& level, std::string_view msg);
+
+    [[nodiscard]]
+    consteval bool compiled(const LogLevel& level) {
+      return static_cast<int>(level) >= LOGGER_MIN_LEVEL;
+    }
+
+    [[nodiscard]]
+    inline bool enabled(const LogLevel& level) {
+      return logging::level.load(std::memory_order_relaxed) <= level;
+    }
+
+    /* formats into a buffer of the calling thread, so no allocation once it has grown */
+    template <typename... Args>
+    void format(const LogLevel& level, std::format_string<Args...> fmt, Args&&... args) {
+      thread_local std::string buffer {};
+      buffer.clear();
+      std::format_to(std::back_inserter(buffer), fmt, std::forward<Args>(args)...);
+      write(level, buffer);
+    }
+  } // logging
+
+  /*
+  * Messages are queued in a buffer of the calling thread and written by a
+  * background thread, so logging never waits on stdout. Messages of one
+  * thread keep their order, a full buffer drops new messages until the
+  * background thread catches up.
+  *
+  * Format arguments are only formatted when the level is enabled, and
+  * levels below LOGGER_MIN_LEVEL are compiled out:
+  *   debug("thread: {}: running task", id);
+  */
   void loglevel(const LogLevel&);
-  void info(const std::string&);
-  void warning(const std::string&);
-  void debug(const std::string&);
-  void error(const std::string&);
+
+  inline void info(std::string_view msg) {
+    if (logging::enabled(LogLevel::Info)) {
+      logging::write(LogLevel::Info, msg);
+    }
+  }
+
+  template <typename... Args>
+  inline void info(std::format_string<Args...> fmt, Args&&... args) {
+    if (logging::enabled(LogLevel::Info)) {
+      logging::format(LogLevel::Info, fmt, std::forward<Args>(args)...);
+    }
+  }
+
+  inline void warning(std::string_view msg) {
+    if (logging::enabled(LogLevel::Warning)) {
+      logging::write(LogLevel::Warning, msg);
+    }
+  }
+
+  template <typename... Args>
+  inline void warning(std::format_string<Args...> fmt, Args&&... args) {
+    if (logging::enabled(LogLevel::Warning)) {
+      logging::format(LogLevel::Warning, fmt, std::forward<Args>(args)...);
+    }
+  }
+
+  inline void debug([[maybe_unused]] std::string_view msg) {
+    if constexpr (logging::compiled(LogLevel::Debug)) {
+      if (logging::enabled(LogLevel::Debug)) {
+        logging::write(LogLevel::Debug, msg);
+      }
+    }
+  }
+
+  template <typename... Args>
+  inline void debug([[maybe_unused]] std::format_string<Args...> fmt, [[maybe_unused]] Args&&... args) {
+    if constexpr (logging::compiled(LogLevel::Debug)) {
+      if (logging::enabled(LogLevel::Debug)) {
+        logging::format(LogLevel::Debug, fmt, std::forward<Args>(args)...);
+      }
+    }
+  }
+
+  inline void error(std::string_view msg) {
+    logging::write(LogLevel::None, msg);
+  }
+
+  template <typename... Args>
+  inline void error(std::format_string<Args...> fmt, Args&&... args) {
+    logging::format(LogLevel::None, fmt, std::forward<Args>(args)...);
+  }
+
+  /*
+  * @brief Write logs to a file instead of stdout and stderr.
+  * @param path Path of the file, appended to.
+  * @return False if the file could not be opened.
+  */
+  bool logfile(const std::string& path);
+
+  /*
+  * @brief Queue an access log record, written as it is without a prefix or a newline.
+  * @param record Record.
+  */
+  void access_log(std::string_view record);
+
+  /*
+  * @brief Write access log records to their own file instead of with the other messages.
+  * @param path Path of the file, appended to.
+  * @return False if the file could not be opened.
+  */
+  bool access_logfile(const std::string& path);
+
+  /*
+  * @brief Write all the messages queued so far, blocks until they are written.
+  */
+  void flush_logs();
+
+  /*
+  * @brief Get the number of messages dropped because a buffer was full.
+  * @return Count.
+  */
+  [[nodiscard]]
+  size_t dropped_logs();
 } // lime
 
 #endif // LIME_UTILS_LOGGER_H
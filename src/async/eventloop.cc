@@ -0,0 +1,338 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <lime/lime.h>
+
+#if defined(__linux__)
+  #include <sys/epoll.h>
+#endif
+
+#ifndef EVENTLOOP_MAX_EVENTS
+  #define EVENTLOOP_MAX_EVENTS 256
+#endif
+
+namespace lime {
+  static thread_local EventLoop* s_current { nullptr };
+
+  namespace backend {
+  #if defined(__linux__)
+    [[nodiscard]]
+    static uint32_t to_native(const uint32_t events) {
+      uint32_t res { EPOLLRDHUP };
+      if (events & EventLoop::Readable) res |= EPOLLIN;
+      if (events & EventLoop::Writable) res |= EPOLLOUT;
+      return res;
+    }
+
+    [[nodiscard]]
+    static uint32_t from_native(const uint32_t events) {
+      uint32_t res { 0 };
+      if (events & EPOLLIN) res |= EventLoop::Readable;
+      if (events & EPOLLOUT) res |= EventLoop::Writable;
+      if (events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) res |= EventLoop::Hangup;
+      return res;
+    }
+  #else
+    [[nodiscard]]
+    static short to_native(const uint32_t events) {
+      short res { 0 };
+      if (events & EventLoop::Readable) res |= POLLIN;
+      if (events & EventLoop::Writable) res |= POLLOUT;
+      return res;
+    }
+
+    [[nodiscard]]
+    static uint32_t from_native(const short events) {
+      uint32_t res { 0 };
+      if (events & POLLIN) res |= EventLoop::Readable;
+      if (events & POLLOUT) res |= EventLoop::Writable;
+      if (events & (POLLHUP | POLLERR | POLLNVAL)) res |= EventLoop::Hangup;
+      return res;
+    }
+  #endif
+  } // backend
+
+  EventLoop::EventLoop(DynamicThreadPool* pool)
+  : m_pool(pool), m_backend(-1), m_wakeup { -1, -1 } {
+  #if defined(__linux__)
+    if (m_backend = epoll_create1(EPOLL_CLOEXEC); m_backend < 0) {
+      error("epoll_create1(): {}", strerror(errno));
+    }
+  #endif
+
+    if (pipe(m_wakeup) < 0) {
+      error("pipe(): {}", strerror(errno));
+      return;
+    }
+
+    for (const int fd: m_wakeup) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+  }
+
+  EventLoop::~EventLoop() {
+    for (const int fd: m_wakeup) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+
+    if (m_backend >= 0) {
+      close(m_backend);
+    }
+  }
+
+  int EventLoop::run() {
+    if (m_wakeup[0] < 0) {
+      return -1;
+    }
+
+    debug("starting event loop");
+    s_current = this;
+    m_stop = false;
+
+    const int wakeup_fd { m_wakeup[0] };
+    if (const int ret = watch(wakeup_fd, Readable, [wakeup_fd](uint32_t) {
+      char buffer[64];
+      while (::read(wakeup_fd, buffer, sizeof(buffer)) > 0) {}
+    }); ret < 0) {
+      s_current = nullptr;
+      return ret;
+    }
+
+    int ret { 0 };
+    while (!m_stop) {
+      if (ret = wait(poll_timeout()); ret < 0) {
+        break;
+      }
+      m_timers.advance(Clock::now());
+      run_posted();
+    }
+
+    unwatch(wakeup_fd);
+    s_current = nullptr;
+    debug("event loop stopped");
+    return ret;
+  }
+
+  void EventLoop::stop() {
+    m_stop = true;
+    wakeup();
+  }
+
+  void EventLoop::post(Callback func) {
+    {
+      std::lock_guard lock { m_posted_mutex };
+      m_posted.emplace_back(std::move(func));
+    }
+    wakeup();
+  }
+
+  void EventLoop::wakeup() {
+    const char byte { 1 };
+    /* a full pipe already guarantees a pending wakeup */
+    [[maybe_unused]] const auto _ = ::write(m_wakeup[1], &byte, 1);
+  }
+
+  void EventLoop::run_posted() {
+    std::vector<Callback> posted {};
+    {
+      std::lock_guard lock { m_posted_mutex };
+      posted.swap(m_posted);
+    }
+
+    for (auto& func: posted) {
+      func();
+    }
+  }
+
+  int EventLoop::watch(int fd, uint32_t events, IOCallback func) {
+    const bool exists { m_watchers.contains(fd) };
+
+  #if defined(__linux__)
+    epoll_event ev {
+      .events = backend::to_native(events),
+      .data = { .fd = fd },
+    };
+
+    if (const int ret = epoll_ctl(
+      m_backend,
+      exists ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+      fd,
+      &ev
+    ); ret < 0) {
+      return ret;
+    }
+  #endif
+
+    if (exists) {
+      auto& watcher { m_watchers.at(fd) };
+      watcher = std::make_shared<Watcher>(events, std::move(func));
+      return 0;
+    }
+
+    m_watchers.emplace(fd, std::make_shared<Watcher>(events, std::move(func)));
+    return 0;
+  }
+
+  void EventLoop::unwatch(int fd) {
+    if (m_watchers.erase(fd) == 0) {
+      return;
+    }
+
+  #if defined(__linux__)
+    epoll_ctl(m_backend, EPOLL_CTL_DEL, fd, nullptr);
+  #endif
+  }
+
+  EventLoop::TimerId EventLoop::add_timer(std::chrono::milliseconds delay, Callback func) {
+    return m_timers.add(Clock::now() + delay, std::move(func));
+  }
+
+  void EventLoop::cancel_timer(TimerId id) {
+    m_timers.cancel(id);
+  }
+
+  int EventLoop::poll_timeout() const {
+    const auto timeout { m_timers.next_timeout(Clock::now()) };
+    if (!timeout) {
+      return -1;
+    }
+
+    return static_cast<int>(timeout->count());
+  }
+
+  int EventLoop::wait(int timeout) {
+    /*
+    * callbacks may unwatch any fd, including their own,
+    * so the watcher is kept alive until its callback returns
+    */
+    const auto dispatch = [this](const int fd, const uint32_t revents) {
+      const auto it { m_watchers.find(fd) };
+      if (it == m_watchers.end()) {
+        return;
+      }
+
+      const std::shared_ptr<Watcher> watcher { it->second };
+      watcher->func(revents);
+    };
+
+  #if defined(__linux__)
+    epoll_event events[EVENTLOOP_MAX_EVENTS];
+    const int count { epoll_wait(m_backend, events, EVENTLOOP_MAX_EVENTS, timeout) };
+    if (count < 0) {
+      return errno == EINTR ? 0 : count;
+    }
+
+    for (int i = 0; i < count; i++) {
+      dispatch(events[i].data.fd, backend::from_native(events[i].events));
+    }
+  #else
+    std::vector<pollfd> fds {};
+    fds.reserve(m_watchers.size());
+    for (const auto& [fd, watcher]: m_watchers) {
+      fds.push_back(pollfd {
+        .fd = fd,
+        .events = backend::to_native(watcher->events),
+        .revents = {},
+      });
+    }
+
+    const int count { ::poll(fds.data(), fds.size(), timeout) };
+    if (count < 0) {
+      return errno == EINTR ? 0 : count;
+    }
+
+    for (const auto& pfd: fds) {
+      if (pfd.revents != 0) {
+        dispatch(pfd.fd, backend::from_native(pfd.revents));
+      }
+    }
+  #endif
+
+    return 0;
+  }
+
+  DynamicThreadPool* EventLoop::pool() const {
+    return m_pool;
+  }
+
+  EventLoop* EventLoop::current() {
+    return s_current;
+  }
+
+  bool EventLoop::IOAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    const int ret {
+      loop->watch(fd, events, [this, handle](uint32_t ready) {
+        revents = ready;
+        loop->unwatch(fd);
+        handle.resume();
+      })
+    };
+
+    /* resume immediately with no events, errno is set by watch() */
+    return ret == 0;
+  }
+
+  void EventLoop::SleepAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    loop->add_timer(delay, [handle]() {
+      handle.resume();
+    });
+  }
+
+  EventLoop::IOAwaiter EventLoop::readable(int fd) {
+    return { this, fd, Readable };
+  }
+
+  EventLoop::IOAwaiter EventLoop::writable(int fd) {
+    return { this, fd, Writable };
+  }
+
+  EventLoop::SleepAwaiter EventLoop::sleep(std::chrono::milliseconds delay) {
+    return { this, delay };
+  }
+
+  Task<ssize_t> EventLoop::read(int fd, void* buffer, size_t len) {
+    while (true) {
+      const ssize_t ret { ::read(fd, buffer, len) };
+      if (ret >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        co_return ret;
+      }
+
+      if ((co_await readable(fd)) == 0) {
+        co_return -1;
+      }
+    }
+  }
+
+  Task<ssize_t> EventLoop::write(int fd, const void* buffer, size_t len) {
+    const char* ptr { static_cast<const char*>(buffer) };
+    size_t written { 0 };
+
+    while (written < len) {
+      const ssize_t ret { ::write(fd, ptr + written, len - written) };
+      if (ret >= 0) {
+        written += ret;
+        continue;
+      }
+
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        co_return ret;
+      }
+
+      if ((co_await writable(fd)) == 0) {
+        co_return -1;
+      }
+    }
+
+    co_return written;
+  }
+
+  EventLoop::SleepAwaiter sleep(std::chrono::milliseconds delay) {
+    return EventLoop::current()->sleep(delay);
+  }
+} // lime
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <lime/lime.h>
+
+namespace lime {
+  TimerWheel::TimerWheel(Clock::time_point now)
+  : m_start(now) {}
+
+  uint64_t TimerWheel::to_tick(Clock::time_point point) const {
+    if (point <= m_start) {
+      return 0;
+    }
+
+    return std::chrono::ceil<std::chrono::milliseconds>(point - m_start).count();
+  }
+
+  /* moves a timer into the level whose slot span covers its deadline */
+  void TimerWheel::place(Slot& from, Slot::iterator it) {
+    /* expired timers fire on the next tick */
+    const uint64_t deadline { std::max(it->deadline, m_current + 1) };
+
+    size_t level { 0 };
+    while (level < Levels - 1 &&
+      (deadline >> (level * LevelBits)) - (m_current >> (level * LevelBits)) >= Slots) {
+        level++;
+      }
+
+    uint64_t index { deadline >> (level * LevelBits) };
+    if ((index - (m_current >> (level * LevelBits))) >= Slots) {
+      /* beyond the wheel, park it in the furthest slot to be re-placed on cascade */
+      index = (m_current >> (level * LevelBits)) + Slots - 1;
+    }
+
+    const size_t slot { index & (Slots - 1) };
+    auto& to { m_wheel[level][slot] };
+    to.splice(to.end(), from, it);
+    m_index.at(it->id) = Location { level, slot, it };
+  }
+
+  TimerWheel::TimerId TimerWheel::add(Clock::time_point deadline, Callback func) {
+    const TimerId id { m_next_id++ };
+
+    Slot pending {};
+    pending.push_back(Timer { id, to_tick(deadline), std::move(func) });
+    m_index.emplace(id, Location { 0, 0, pending.begin() });
+    place(pending, pending.begin());
+
+    return id;
+  }
+
+  void TimerWheel::cancel(TimerId id) {
+    const auto it { m_index.find(id) };
+    if (it == m_index.end()) {
+      return;
+    }
+
+    const auto& [level, slot, timer] { it->second };
+    m_wheel[level][slot].erase(timer);
+    m_index.erase(it);
+  }
+
+  void TimerWheel::cascade(size_t level) {
+    auto& slot { m_wheel[level][(m_current >> (level * LevelBits)) & (Slots - 1)] };
+    while (!slot.empty()) {
+      place(slot, slot.begin());
+    }
+  }
+
+  void TimerWheel::tick() {
+    m_current++;
+
+    for (size_t level = 1; level < Levels; level++) {
+      if ((m_current & ((uint64_t { 1 } << (level * LevelBits)) - 1)) != 0) {
+        break;
+      }
+      cascade(level);
+    }
+
+    /* callbacks may add or cancel timers, including ones in this slot */
+    auto& slot { m_wheel[0][m_current & (Slots - 1)] };
+    while (!slot.empty()) {
+      if (slot.front().deadline > m_current) {
+        place(slot, slot.begin());
+        continue;
+      }
+
+      Callback func { std::move(slot.front().func) };
+      m_index.erase(slot.front().id);
+      slot.pop_front();
+      func();
+    }
+  }
+
+  void TimerWheel::advance(Clock::time_point now) {
+    const uint64_t target {
+      now <= m_start ? 0 :
+      static_cast<uint64_t>(std::chrono::floor<std::chrono::milliseconds>(now - m_start).count())
+    };
+
+    while (m_current < target) {
+      if (m_index.empty()) {
+        m_current = target;
+        return;
+      }
+      tick();
+    }
+  }
+
+  std::optional<std::chrono::milliseconds> TimerWheel::next_timeout(Clock::time_point now) const {
+    if (m_index.empty()) {
+      return std::nullopt;
+    }
+
+    const uint64_t current {
+      now <= m_start ? 0 :
+      static_cast<uint64_t>(std::chrono::floor<std::chrono::milliseconds>(now - m_start).count())
+    };
+
+    if (current > m_current) {
+      return std::chrono::milliseconds { 0 };
+    }
+
+    /* nearest occupied slot of the finest level, otherwise the next cascade */
+    for (uint64_t tick = m_current + 1; tick < m_current + Slots; tick++) {
+      if (!m_wheel[0][tick & (Slots - 1)].empty()) {
+        return std::chrono::milliseconds { tick - m_current };
+      }
+
+      if ((tick & (Slots - 1)) == 0) {
+        return std::chrono::milliseconds { tick - m_current };
+      }
+    }
+
+    return std::chrono::milliseconds { Slots - (m_current & (Slots - 1)) };
+  }
+
+  size_t TimerWheel::size() const {
+    return m_index.size();
+  }
+} // lime
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <charconv>
+#include <cstring>
+#include <lime/lime.h>
+#include <lime/http/accesslog.h>
+#include <lime/json/escape.h>
+
+namespace lime {
+  namespace http {
+    namespace record {
+      template <typename T>
+      static void put(std::string& out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+      }
+
+      template <typename T>
+      static void number(std::string& out, T value) {
+        char buffer[24];
+        const auto [end, _] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, end);
+      }
+
+      /* appended piece by piece, a record is written for every request */
+      static void json(const AccessRecord& record, std::string& out) {
+        char peer[INET_ADDRSTRLEN] {};
+        inet_ntop(AF_INET, &record.peer.sin_addr, peer, sizeof(peer));
+
+        out += "{\"ts\":";
+        number(out, std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count());
+        out += ",\"method\":\"";
+        out += to_string(record.method);
+        out += "\",\"path\":";
+        json::escape(record.path, out);
+        out += ",\"status\":";
+        number(out, static_cast<int>(record.status));
+        out += ",\"bytes\":";
+        number(out, record.bytes);
+        out += ",\"latency_us\":";
+        number(out, record.latency.count());
+        out += ",\"peer\":\"";
+        out += peer;
+        out += ':';
+        number(out, ntohs(record.peer.sin_port));
+        out += "\"}\n";
+      }
+
+      static void binary(const AccessRecord& record, std::string& out) {
+        const size_t begin { out.size() };
+        put<uint32_t>(out, 0);
+        put<uint64_t>(out, std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count());
+        put<uint32_t>(out, static_cast<uint32_t>(std::min<int64_t>(record.latency.count(), UINT32_MAX)));
+        put<uint64_t>(out, record.bytes);
+        put<uint32_t>(out, record.peer.sin_addr.s_addr);
+        put<uint16_t>(out, ntohs(record.peer.sin_port));
+        put<uint16_t>(out, static_cast<uint16_t>(record.status));
+        put<uint8_t>(out, static_cast<uint8_t>(record.method));
+        out.append(record.path);
+
+        const uint32_t size { static_cast<uint32_t>(out.size() - begin) };
+        std::memcpy(out.data() + begin, &size, sizeof(size));
+      }
+    } // record
+
+    AccessLogger::AccessLogger()
+    : m_state(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) | 1) {
+      options(AccessLog {});
+    }
+
+    void AccessLogger::options(const AccessLog& options) {
+      m_options = options;
+
+      const double sample { std::clamp(options.sample, 0.0, 1.0) };
+      m_threshold = sample >= 1.0 ? UINT64_MAX : static_cast<uint64_t>(sample * 0x1p64);
+    }
+
+    const AccessLog& AccessLogger::options() const {
+      return m_options;
+    }
+
+    bool AccessLogger::wants(std::chrono::microseconds latency) {
+      if (!m_options.enabled) {
+        return false;
+      }
+
+      if (m_options.slow.count() > 0 && latency >= m_options.slow) {
+        return true;
+      }
+
+      if (m_threshold == UINT64_MAX) {
+        return true;
+      }
+
+      /* xorshift64*, good enough to pick requests evenly */
+      m_state ^= m_state >> 12;
+      m_state ^= m_state << 25;
+      m_state ^= m_state >> 27;
+      return m_state * 0x2545F4914F6CDD1DULL < m_threshold;
+    }
+
+    void AccessLogger::log(const AccessRecord& record) {
+      m_buffer.clear();
+      encode(record, m_options.format, m_buffer);
+      access_log(m_buffer);
+    }
+
+    void AccessLogger::encode(const AccessRecord& record, const AccessLog::Format& format, std::string& out) {
+      if (format == AccessLog::Format::Binary) {
+        record::binary(record, out);
+        return;
+      }
+      record::json(record, out);
+    }
+  } // http
+} // lime
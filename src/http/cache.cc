@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <lime/lime.h>
+#include <lime/http/cache.h>
+
+namespace lime {
+  namespace http {
+    std::string CachedResponse::serialize(const bool keep_alive) const {
+      if (keep_alive || connection == std::string::npos) {
+        return data;
+      }
+
+      static constexpr std::string_view KeepAlive { "keep-alive" };
+      static constexpr std::string_view Close { "close" };
+
+      std::string res {};
+      res.reserve(data.size() - KeepAlive.size() + Close.size());
+      res.append(data, 0, connection);
+      res.append(Close);
+      res.append(data, connection + KeepAlive.size());
+      return res;
+    }
+
+    ResponseCache::ResponseCache(size_t capacity)
+    : m_capacity(capacity),
+      m_hits(metrics::registry().counter("lime_cache_hits_total", "Requests answered from the response cache")),
+      m_misses(metrics::registry().counter("lime_cache_misses_total", "Cache lookups without a fresh response")),
+      m_evictions(metrics::registry().counter("lime_cache_evictions_total", "Responses evicted to make room in the response cache")),
+      m_bytes(metrics::registry().gauge("lime_cache_bytes", "Bytes of responses in the response cache")) {}
+
+    ResponseCache::~ResponseCache() {
+      m_bytes.sub(static_cast<int64_t>(bytes()));
+    }
+
+    std::string ResponseCache::key(const Request& req, const CachePolicy& policy) {
+      std::string res { to_string(req.method) };
+      res += ' ';
+      res += req.url;
+
+      /* sorted so the order of the parameters in the url does not matter */
+      std::vector<std::pair<std::string_view, std::string_view>> params {};
+      if (policy.params) {
+        for (const auto& name: *policy.params) {
+          const auto it { req.params.find(name) };
+          if (it != req.params.end()) {
+            params.emplace_back(it->first, it->second);
+          }
+        }
+      } else {
+        params.assign(req.params.begin(), req.params.end());
+      }
+      std::sort(params.begin(), params.end());
+
+      char separator { '?' };
+      for (const auto& [name, value]: params) {
+        res += separator;
+        res += name;
+        res += '=';
+        res += value;
+        separator = '&';
+      }
+
+      /* values can not hold a newline, the parser splits lines on it */
+      for (const auto& name: policy.headers) {
+        res += '\n';
+        res += name;
+        const auto it { req.header.find(name) };
+        if (it != req.header.end()) {
+          res += ':';
+          res += it->second;
+        }
+      }
+      return res;
+    }
+
+    ResponseCache::Shard& ResponseCache::shard(std::string_view key) {
+      return m_shards[std::hash<std::string_view> {}(key) % CACHE_SHARDS];
+    }
+
+    void ResponseCache::remove(Shard& shard, std::list<Entry>::iterator it) {
+      const size_t size { it->first.size() + it->second->data.size() };
+      shard.bytes -= size;
+      m_bytes.sub(static_cast<int64_t>(size));
+      shard.index.erase(it->first);
+      shard.entries.erase(it);
+    }
+
+    std::shared_ptr<const CachedResponse> ResponseCache::find(std::string_view key) {
+      Shard& s { shard(key) };
+      std::lock_guard lock { s.mutex };
+
+      const auto it { s.index.find(key) };
+      if (it == s.index.end()) {
+        m_misses.add();
+        return nullptr;
+      }
+
+      if (it->second->second->expires <= std::chrono::steady_clock::now()) {
+        remove(s, it->second);
+        m_misses.add();
+        return nullptr;
+      }
+
+      s.entries.splice(s.entries.begin(), s.entries, it->second);
+      m_hits.add();
+      return it->second->second;
+    }
+
+    void ResponseCache::insert(const std::string& key, std::shared_ptr<const CachedResponse> response) {
+      const size_t size { key.size() + response->data.size() };
+      const size_t limit { m_capacity.load(std::memory_order_relaxed) / CACHE_SHARDS };
+
+      Shard& s { shard(key) };
+      std::lock_guard lock { s.mutex };
+
+      if (const auto it { s.index.find(key) }; it != s.index.end()) {
+        remove(s, it->second);
+      }
+
+      if (size > limit) {
+        return;
+      }
+
+      while (s.bytes + size > limit && !s.entries.empty()) {
+        remove(s, std::prev(s.entries.end()));
+        m_evictions.add();
+      }
+
+      s.entries.emplace_front(key, std::move(response));
+      s.index.emplace(s.entries.front().first, s.entries.begin());
+      s.bytes += size;
+      m_bytes.add(static_cast<int64_t>(size));
+    }
+
+    void ResponseCache::erase(std::string_view key) {
+      Shard& s { shard(key) };
+      std::lock_guard lock { s.mutex };
+
+      if (const auto it { s.index.find(key) }; it != s.index.end()) {
+        remove(s, it->second);
+      }
+    }
+
+    void ResponseCache::clear() {
+      for (auto& s: m_shards) {
+        std::lock_guard lock { s.mutex };
+        m_bytes.sub(static_cast<int64_t>(s.bytes));
+        s.index.clear();
+        s.entries.clear();
+        s.bytes = 0;
+      }
+    }
+
+    void ResponseCache::capacity(size_t bytes) {
+      m_capacity.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t ResponseCache::capacity() const {
+      return m_capacity.load(std::memory_order_relaxed);
+    }
+
+    size_t ResponseCache::size() const {
+      size_t res { 0 };
+      for (const auto& s: m_shards) {
+        std::lock_guard lock { s.mutex };
+        res += s.entries.size();
+      }
+      return res;
+    }
+
+    size_t ResponseCache::bytes() const {
+      size_t res { 0 };
+      for (const auto& s: m_shards) {
+        std::lock_guard lock { s.mutex };
+        res += s.bytes;
+      }
+      return res;
+    }
+  } // http
+} // lime
@@ -0,0 +1,35 @@
+#include <lime/lime.h>
+
+namespace lime {
+  namespace http {
+    namespace header {
+      [[nodiscard]]
+      static constexpr char lower(const char ch) {
+        return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + ('a' - 'A')) : ch;
+      }
+    } // header
+
+    size_t HeaderHash::operator()(std::string_view name) const {
+      /* fnv-1a over the lowercased name */
+      size_t hash { 14695981039346656037ull };
+      for (const char ch: name) {
+        hash ^= static_cast<unsigned char>(header::lower(ch));
+        hash *= 1099511628211ull;
+      }
+      return hash;
+    }
+
+    bool HeaderEqual::operator()(std::string_view lhs, std::string_view rhs) const {
+      if (lhs.size() != rhs.size()) {
+        return false;
+      }
+
+      for (size_t i = 0; i < lhs.size(); i++) {
+        if (header::lower(lhs[i]) != header::lower(rhs[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+  } // http
+} // lime
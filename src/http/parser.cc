@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <lime/lime.h>
+#include <lime/http/parser.h>
+
+namespace lime {
+  namespace http {
+    using ParsedURL = std::pair<std::string, std::unordered_map<std::string, std::string>>;
+
+    static const std::unordered_map<std::string, http::Method> methods {
+      { "GET", http::Method::Get },
+      { "POST", http::Method::Post },
+      { "PUT", http::Method::Put },
+      { "DELETE", http::Method::Delete },
+    };
+
+    namespace parser {
+      [[nodiscard]]
+      static ParsedURL url(const std::string& url) {
+        debug("parsing url");
+        const size_t pos { url.find("?") };
+        if (pos == std::string::npos) {
+          return { url, {} };
+        }
+
+        const std::string str { url.substr(pos + 1) };
+        std::unordered_map<std::string, std::string> params {};
+        std::string key {}, value {};
+        bool setval { false };
+
+        debug("parsing params");
+        for (size_t i = 0; i < str.length(); i++) {
+          switch (str[i]) {
+            case '&': {
+              params[key] = value;
+              key.clear(); value.clear();
+              setval = false;
+              break;
+            }
+
+            case '=': {
+              setval = true;
+              break;
+            }
+
+            default: {
+              if (setval) {
+                value += str[i];
+              } else {
+                key += str[i];
+              }
+            }
+          }
+
+          if (i == str.length() - 1) {
+            params[key] = value;
+          }
+        }
+
+        return {
+          url.substr(0, pos),
+          params
+        };
+      }
+
+      [[nodiscard]]
+      static std::pair<std::string, std::string> headerline(const std::string& line) {
+        const auto trim = [](std::string s) {
+          s.erase(
+            s.begin(),
+            std::find_if(
+              s.begin(),
+              s.end(),
+              [](unsigned char ch) {
+                return !std::isspace(ch);
+              }
+            )
+          );
+
+          s.erase(
+            std::find_if(
+              s.rbegin(),
+              s.rend(),
+              [](unsigned char ch) {
+                return !std::isspace(ch);
+              }
+            ).base(),
+            s.end()
+          );
+
+          return s;
+        };
+
+        const size_t pos { line.find(":") };
+        if (pos == std::string::npos) {
+          return {};
+        }
+
+        return { trim(line.substr(0, pos)), trim(line.substr(pos + 1)) };
+      }
+
+      [[nodiscard]]
+      static std::string lowercase(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char ch) {
+          return std::tolower(ch);
+        });
+        return s;
+      }
+
+      /* splits the next line off the head, stripping "\r\n" or "\n" */
+      [[nodiscard]]
+      static std::string_view nextline(std::string_view& head) {
+        const size_t pos { head.find('\n') };
+        std::string_view line { head.substr(0, pos) };
+        head.remove_prefix(pos == std::string_view::npos ? head.size() : pos + 1);
+
+        if (!line.empty() && line.back() == '\r') {
+          line.remove_suffix(1);
+        }
+        return line;
+      }
+    } // parser
+
+    RequestParser::State RequestParser::feed(std::string_view data) {
+      if (m_state != State::Incomplete) {
+        m_buffer.append(data);
+        return m_state;
+      }
+
+      m_buffer.append(data);
+
+      if (m_stage == Stage::Head) {
+        /* the head ends with an empty line, either "\n\r\n" or "\n\n" */
+        const size_t from { std::max(m_scanned, m_consumed) };
+        const size_t crlf { m_buffer.find("\n\r\n", from) };
+        const size_t lf { m_buffer.find("\n\n", from) };
+        const size_t end { std::min(crlf, lf) };
+
+        if (end == std::string::npos) {
+          m_scanned = std::max(m_consumed, m_buffer.size() < 2 ? 0 : m_buffer.size() - 2);
+          return check_partial_head();
+        }
+
+        if (parse_head(end) == State::Error) {
+          return m_state;
+        }
+        m_consumed = end + (end == crlf ? 3 : 2);
+        m_stage = Stage::Body;
+      }
+
+      if (m_stage == Stage::Body) {
+        if (m_buffer.size() - m_consumed < m_body_length) {
+          return m_state;
+        }
+
+        debug("parsing body");
+        m_request.body = m_buffer.substr(m_consumed, m_body_length);
+        m_consumed += m_body_length;
+        m_stage = Stage::Done;
+        m_state = State::Complete;
+      }
+
+      return m_state;
+    }
+
+    RequestParser::RequestParser(const Limits& limits)
+    : m_limits(limits) {}
+
+    /* rejects a head that can no longer fit in the limits before it is complete */
+    RequestParser::State RequestParser::check_partial_head() {
+      const size_t line_end { m_buffer.find('\n', m_consumed) };
+      const size_t line_length {
+        (line_end == std::string::npos ? m_buffer.size() : line_end) - m_consumed
+      };
+
+      if (line_length > m_limits.uri_length + REQUEST_LINE_OVERHEAD) {
+        return fail(StatusCode::URITooLong);
+      }
+
+      if (line_end != std::string::npos && m_buffer.size() - line_end - 1 > m_limits.header_bytes) {
+        return fail(StatusCode::RequestHeaderFieldsTooLarge);
+      }
+
+      return m_state;
+    }
+
+    RequestParser::State RequestParser::parse_head(size_t end) {
+      std::string_view head {
+        std::string_view { m_buffer }.substr(m_consumed, end - m_consumed)
+      };
+
+      debug("parsing request line");
+      std::istringstream request_line_stream { std::string { parser::nextline(head) } };
+      std::string method, raw_url, version;
+      request_line_stream >> method >> raw_url >> version;
+
+      if (!methods.contains(method)) {
+        return fail(StatusCode::BadRequest);
+      }
+
+      if (raw_url.length() > m_limits.uri_length) {
+        return fail(StatusCode::URITooLong);
+      }
+
+      if (head.length() > m_limits.header_bytes) {
+        return fail(StatusCode::RequestHeaderFieldsTooLarge);
+      }
+
+      /* purl -> parsed url */
+      auto [purl, params] { parser::url(raw_url) };
+
+      debug("parsing headers");
+      http::Header header {};
+      while (!head.empty()) {
+        const auto& res { parser::headerline(std::string { parser::nextline(head) }) };
+        if (res.first.length() == 0) {
+          continue;
+        }
+
+        if (header.size() >= m_limits.header_count) {
+          return fail(StatusCode::RequestHeaderFieldsTooLarge);
+        }
+
+        /* names are compared ignoring case, the first of repeated headers is kept */
+        const auto [it, inserted] { header.insert(res) };
+        /* differing lengths would frame the body two ways */
+        if (!inserted && HeaderEqual {}(it->first, "Content-Length") && it->second != res.second) {
+          return fail(StatusCode::BadRequest);
+        }
+      }
+
+      if (header.contains("Transfer-Encoding")) {
+        return fail(StatusCode::NotImplemented);
+      }
+
+      m_body_length = 0;
+      if (header.contains("Content-Length")) {
+        const auto& value { header.at("Content-Length") };
+        const auto [ptr, ec] {
+          std::from_chars(value.data(), value.data() + value.size(), m_body_length)
+        };
+
+        if (ec == std::errc::result_out_of_range) {
+          return fail(StatusCode::ContentTooLarge);
+        }
+
+        if (ec != std::errc {} || ptr != value.data() + value.size()) {
+          return fail(StatusCode::BadRequest);
+        }
+
+        if (m_body_length > m_limits.body_bytes) {
+          return fail(StatusCode::ContentTooLarge);
+        }
+        debug("got body length: {}", m_body_length);
+      }
+
+      const auto connection {
+        header.contains("Connection") ? parser::lowercase(header.at("Connection")) : std::string {}
+      };
+      m_keep_alive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+
+      m_request.method = methods.at(method);
+      m_request.url = std::move(purl);
+      m_request.params = std::move(params);
+      m_request.header = std::move(header);
+      return m_state;
+    }
+
+    RequestParser::State RequestParser::fail(const StatusCode& code) {
+      m_error = code;
+      m_state = State::Error;
+      return m_state;
+    }
+
+    Request& RequestParser::request() {
+      return m_request;
+    }
+
+    StatusCode RequestParser::error() const {
+      return m_error;
+    }
+
+    RequestParser::State RequestParser::state() const {
+      return m_state;
+    }
+
+    bool RequestParser::idle() const {
+      return m_stage == Stage::Head && m_buffer.size() == m_consumed;
+    }
+
+    bool RequestParser::head_done() const {
+      return m_stage != Stage::Head;
+    }
+
+    bool RequestParser::keep_alive() const {
+      return m_keep_alive;
+    }
+
+    void RequestParser::reset() {
+      m_buffer.erase(0, m_consumed);
+      m_scanned = 0;
+      m_consumed = 0;
+      m_body_length = 0;
+      m_keep_alive = false;
+      m_stage = Stage::Head;
+      m_state = State::Incomplete;
+      m_error = StatusCode::BadRequest;
+      m_request = {};
+    }
+  } // http
+} // lime
@@ -17,5 +17,46 @@ namespace lime {
       }
       return result;
     }
+
+    namespace tags {
+      /* the opaque part of an entity tag, without W/ and quotes */
+      [[nodiscard]]
+      static std::string_view opaque(std::string_view tag) {
+        if (tag.starts_with("W/")) {
+          tag.remove_prefix(2);
+        }
+        if (tag.size() >= 2 && tag.front() == '"' && tag.back() == '"') {
+          tag = tag.substr(1, tag.size() - 2);
+        }
+        return tag;
+      }
+    } // tags
+
+    bool Request::not_modified(std::string_view tag) const {
+      const auto it { header.find("If-None-Match") };
+      if (it == header.end()) {
+        return false;
+      }
+
+      const std::string_view wanted { tags::opaque(tag) };
+      std::string_view list { it->second };
+      while (!list.empty()) {
+        const size_t comma { list.find(',') };
+        std::string_view item { list.substr(0, comma) };
+        list = comma == std::string_view::npos ? std::string_view {} : list.substr(comma + 1);
+
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) {
+          item.remove_prefix(1);
+        }
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) {
+          item.remove_suffix(1);
+        }
+
+        if (item == "*" || tags::opaque(item) == wanted) {
+          return true;
+        }
+      }
+      return false;
+    }
   } // http
 } // lime
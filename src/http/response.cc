@@ -1,3 +1,5 @@
+#include <cstdint>
+#include <cstring>
 #include <format>
 #include <lime/http/request.h>
 #include <string>
@@ -23,12 +25,64 @@ namespace lime {
       }
     } // header
 
+    namespace hash {
+      static constexpr uint64_t Seed { 0xa0761d6478bd642full };
+      static constexpr uint64_t Prime { 0xe7037ed1a0b428dbull };
+
+      /* folds the 128 bit product, every input bit reaches every output bit */
+      [[nodiscard]]
+      static uint64_t mix(uint64_t a, uint64_t b) {
+        const unsigned __int128 product { static_cast<unsigned __int128>(a) * b };
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+      }
+
+      [[nodiscard]]
+      static uint64_t load(const char* data) {
+        uint64_t res {};
+        std::memcpy(&res, data, sizeof(res));
+        return res;
+      }
+
+      /* 16 bytes per multiplication, in the manner of wyhash */
+      [[nodiscard]]
+      static uint64_t body(std::string_view data) {
+        uint64_t res { Seed ^ data.size() };
+        size_t i { 0 };
+        for (; i + 16 <= data.size(); i += 16) {
+          res = mix(load(data.data() + i) ^ Prime, load(data.data() + i + 8) ^ res);
+        }
+
+        char tail[16] {};
+        std::memcpy(tail, data.data() + i, data.size() - i);
+        res = mix(load(tail) ^ Prime, load(tail + 8) ^ res);
+        return mix(res ^ Seed, data.size() ^ Prime);
+      }
+    } // hash
+
+    std::string etag(std::string_view body) {
+      static constexpr char Digits[] { "0123456789abcdef" };
+
+      uint64_t value { hash::body(body) };
+      std::string res(16, '0');
+      for (size_t i = res.size(); i > 0; i--) {
+        res[i - 1] = Digits[value & 0xf];
+        value >>= 4;
+      }
+      return res;
+    }
+
     Response::Response(const std::string& body)
     : m_body(body), m_code(StatusCode::Ok) {
       header::set_defaults(m_header);
       append_header("Content-Length", std::to_string(body.size()));
     }
 
+    Response::Response(std::string&& body)
+    : m_body(std::move(body)), m_code(StatusCode::Ok) {
+      header::set_defaults(m_header);
+      append_header("Content-Length", std::to_string(m_body.size()));
+    }
+
     Response::Response(const StatusCode& code)
     : m_body(""), m_code(code) {
       header::set_defaults(m_header);
@@ -41,18 +95,55 @@ namespace lime {
       append_header("Content-Length", std::to_string(body.size()));
     }
 
+    Response::Response(std::string&& body, const StatusCode& code)
+    : m_body(std::move(body)), m_code(code) {
+      header::set_defaults(m_header);
+      append_header("Content-Length", std::to_string(m_body.size()));
+    }
+
     void Response::append_header(const std::string& key, const std::string& value) {
       m_header.insert({ key, value });
     }
+
+    void Response::set_header(const std::string& key, const std::string& value) {
+      m_header.insert_or_assign(key, value);
+    }
+
+    void Response::remove_header(const std::string& key) {
+      m_header.erase(key);
+    }
+
+    void Response::set_etag(const std::string& tag, const bool weak) {
+      set_header("ETag", std::format("{}\"{}\"", weak ? "W/" : "", tag));
+    }
+
     void Response::set_body(const std::string& vbody) {
       m_body = vbody;
-      append_header("Content-Length", std::to_string(m_body.size()));
+      set_header("Content-Length", std::to_string(m_body.size()));
+    }
+
+    void Response::set_body(std::string&& vbody) {
+      m_body = std::move(vbody);
+      set_header("Content-Length", std::to_string(m_body.size()));
     }
 
     void Response::set_code(const StatusCode& vcode) {
       m_code = vcode;
     }
 
+    const StatusCode& Response::code() const {
+      return m_code;
+    }
+
+    const std::string* Response::header(const std::string& key) const {
+      const auto it { m_header.find(key) };
+      return it != m_header.end() ? &it->second : nullptr;
+    }
+
+    const std::string& Response::body() const {
+      return m_body;
+    }
+
     std::string Response::to_string() const {
       return std::format(
         HTTP_VERSION" {} {}\n{}\r\n{}",
@@ -1,241 +1,26 @@
-#include <memory>
-#include <unistd.h>
-#include <sys/poll.h>
-#include <sys/types.h>
 #include <algorithm>
-#include <cstddef>
-#include <cstdio>
 #include <format>
-#include <optional>
 #include <regex>
-#include <unordered_map>
-#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <lime/lime.h>
-
-#ifndef CLIENT_POLLING_TIMEOUT
-  #define CLIENT_POLLING_TIMEOUT 50
-#endif
-
-#ifndef CLIENT_READ_BUFFER_SIZE
-  #define CLIENT_READ_BUFFER_SIZE 512
-#endif
+#include <lime/metrics/prometheus.h>
 
 namespace lime {
   namespace http {
-    using ParsedURL = std::pair<std::string, std::unordered_map<std::string, std::string>>;
-
-    static const std::unordered_map<std::string, http::Method> methods {
-      { "GET", http::Method::Get },
-      { "POST", http::Method::Post },
-      { "PUT", http::Method::Put },
-      { "DELETE", http::Method::Delete },
-    };
-
-    namespace parser {
-      /* reads one line from client fd at a time */
-      [[nodiscard]]
-      static std::string readline(const int& fd) {
-        std::string line {}; char ch {};
-        while (read(fd, &ch, 1) > 0) {
-          if(ch == '\n') {
-            break;
-          }
-          line += ch;
-        }
-        return line;
-      }
-
-      [[nodiscard]]
-      static ParsedURL url(const std::string& url) {
-        debug("parsing url");
-        const size_t pos { url.find("?") };
-        if (pos == std::string::npos) {
-          return { url, {} };
-        }
-
-        const std::string str { url.substr(pos + 1) };
-        std::unordered_map<std::string, std::string> params {};
-        std::string key {}, value {};
-        bool setval { false };
-
-        debug("parsing params");
-        for (size_t i = 0; i < str.length(); i++) {
-          switch (str[i]) {
-            case '&': {
-              params[key] = value;
-              key.clear(); value.clear();
-              setval = false;
-              break;
-            }
-
-            case '=': {
-              setval = true;
-              break;
-            }
-
-            default: {
-              if (setval) {
-                value += str[i];
-              } else {
-                key += str[i];
-              }
-            }
-          }
-
-          if (i == str.length() - 1) {
-            params[key] = value;
-          }
-        }
-
-        return {
-          url.substr(0, pos),
-          params
-        };
-      }
-
-      [[nodiscard]]
-      static std::pair<std::string, std::string> headerline(const std::string& line) {
-        const auto trim = [](std::string s) {
-          s.erase(
-            s.begin(),
-            std::find_if(
-              s.begin(),
-              s.end(),
-              [](unsigned char ch) {
-                return !std::isspace(ch);
-              }
-            )
-          );
-
-          s.erase(
-            std::find_if(
-              s.rbegin(),
-              s.rend(),
-              [](unsigned char ch) {
-                return !std::isspace(ch);
-              }
-            ).base(),
-            s.end()
-          );
-
-          return s;
-        };
-
-        const size_t pos { line.find(":") };
-        if (pos == std::string::npos) {
-          return {};
-        }
-
-        return { trim(line.substr(0, pos)), trim(line.substr(pos + 1)) };
-      }
-
-      /* parses entire http body */
-      [[nodiscard]]
-      static std::string body(const int& fd, const std::optional<size_t>& vlen) {
-        debug("parsing body");
-        if (vlen) {
-          debug(std::format("got body length: {}", *vlen));
-          size_t len { *vlen };
-          std::unique_ptr<char[]> buffer { new char[len + 1] };
-          char* ptr = buffer.get();
-
-          /* TODO: error handling from read */
-          len = read(fd, ptr, len);
-          buffer[len] = '\0';
-
-          return { ptr };
-        }
-
-        thread_local static std::array<char, CLIENT_READ_BUFFER_SIZE> buffer {};
-        std::string body {};
-
-        pollfd fds[1] {
-          (pollfd){
-            .fd = fd,
-            .events = POLLIN,
-            .revents = {}
-          },
-        };
-
-        while(true) {
-          debug("waiting for read using poll()");
-          if (poll(fds, 1, CLIENT_POLLING_TIMEOUT) <= 0) {
-            break;
-          }
-
-          if (fds[0].revents & POLLIN) {
-            const ssize_t len { read(fd, buffer.data(), buffer.size() - 1) };
-            if (len <= 0) {
-              break;
-            }
-
-            buffer[len] = '\0';
-            body.append(buffer.data(), len);
-          }
-        }
-
-        return body;
-      }
-
-      /* parses the http request */
-      [[nodiscard]]
-      static std::optional<http::Request> parse(const int& fd) {
-        /* TODO: error handling for length = 0 or bad request */
-        debug("parsing request line");
-        const std::string request_line { readline(fd) };
-        std::istringstream requst_line_stream { request_line };
-        std::string method, raw_url, version;
-        requst_line_stream >> method >> raw_url >> version;
-
-        /* purl -> parsed url */
-        const auto &[purl, params] { url(raw_url) };
-
-        debug("parsing headers");
-        http::Header header {};
-        while (true) {
-          std::string header_line { readline(fd) };
-          if (header_line == "\r" || header_line.empty()) {
-            break;
-          }
-
-          const auto& res { headerline(header_line) };
-          if (res.first.length() != 0) {
-            header.insert(res);
-          }
-        }
-
-        if (!methods.contains(method)) {
-          return std::nullopt;
-        }
-
-        return http::Request {
-          .method = methods.at(method),
-          .url = purl,
-          .params = params,
-          .header = header,
-          .body = body(
-            fd,
-            header.contains("Content-Length") ?
-            std::optional<size_t>(std::stol(header.at("Content-Length"))) :
-            std::nullopt
-          ) ,
-        };
-      }
-    } // parser
-
-    void Router::add(const std::string& url, const Method& method, const RouteFunc& func) {
+    void Router::add_handler(const std::string& url, const Method& method, Handler func) {
       if (!m_static_routes.contains(url)) {
-        m_static_routes[url] = {{ method, func }};
+        m_static_routes[url] = {{ method, Route { url, method, func } }};
         return;
       }
 
       auto& method_table { m_static_routes.at(url) };
-      method_table[method] = func;
+      method_table.insert_or_assign(method, Route { url, method, func });
     }
 
-    void Router::add_regex(const std::string& url, const Method& method, const RouteFunc& func) {
+    void Router::add_regex_handler(const std::string& url, const Method& method, Handler func) {
       const auto& res = std::find_if(
         m_regex_routes.begin(),
         m_regex_routes.end(),
@@ -247,39 +32,93 @@ namespace lime {
       if (res == m_regex_routes.end()) {
         m_regex_routes.emplace_back(
           RegexWrapper { std::regex{ url }, url },
-          RouteMethodTable {{ method, func }}
+          RouteMethodTable {{ method, Route { url, method, func } }}
         );
         return;
       }
 
-      res->second[method] = func;
+      res->second.insert_or_assign(method, Route { url, method, func });
+    }
+
+    void Router::add(const std::string& url, const Method& method, const RouteFunc& func) {
+      add_handler(url, method, func);
+    }
+
+    void Router::add(const std::string& url, const Method& method, const AsyncRouteFunc& func) {
+      add_handler(url, method, func);
     }
 
-    std::string Router::handle(const int& fd) const {
-      const std::optional<Request> req_opt { parser::parse(fd) };
-      if (!req_opt) {
-        return Response { StatusCode::BadRequest }.to_string();
+    void Router::add_regex(const std::string& url, const Method& method, const RouteFunc& func) {
+      add_regex_handler(url, method, func);
+    }
+
+    void Router::add_regex(const std::string& url, const Method& method, const AsyncRouteFunc& func) {
+      add_regex_handler(url, method, func);
+    }
+
+    void Router::cache(const std::string& url, const Method& method, const CachePolicy& policy) {
+      /* the key leaves out the body, so only requests without side effects may share a response */
+      if (method != Method::Get) {
+        throw std::invalid_argument(std::format("{} responses of '{}' can not be cached, only GET", to_string(method), url));
+      }
+
+      RouteMethodTable* table { nullptr };
+      if (const auto it { m_static_routes.find(url) }; it != m_static_routes.end()) {
+        table = &it->second;
+      }
+
+      for (auto& [regex, methods]: m_regex_routes) {
+        if (table == nullptr && regex.string == url) {
+          table = &methods;
+        }
+      }
+
+      if (table == nullptr || !table->contains(method)) {
+        throw std::invalid_argument(std::format("no {} route for '{}' to cache", to_string(method), url));
       }
 
-      const Request& req { *req_opt };
-      info(std::format(
+      table->at(method).cache = policy;
+    }
+
+    void Router::add_metrics(const std::string& path) {
+      add_handler(path, Method::Get, RouteFunc { [](const Request&) {
+        Response res { metrics::prometheus(metrics::registry()) };
+        res.set_header("Content-Type", metrics::PrometheusContentType);
+        return res;
+      }});
+    }
+
+    void Router::add_trace(const std::string& path) {
+      add_handler(path, Method::Get, RouteFunc { [](const Request&) {
+        Response res { trace::chrome() };
+        res.set_header("Content-Type", "application/json");
+        return res;
+      }});
+    }
+
+    const Handler* Router::match(const Request& req) const {
+      const Route* route { find(req) };
+      return route != nullptr ? &route->handler : nullptr;
+    }
+
+    const Route* Router::find(const Request& req) const {
+      debug(
         "{} on {}",
         to_string(req.method),
         req.url
-      ));
+      );
 
       if (m_static_routes.contains(req.url)) {
         const auto& method_table { m_static_routes.at(req.url) };
         if (method_table.contains(req.method)) {
-          const auto& func { method_table.at(req.method) };
-          return func(req).to_string();
+          return &method_table.at(req.method);
         }
       }
 
       const auto& res = std::find_if(
         m_regex_routes.begin(),
         m_regex_routes.end(),
-        [req](const std::pair<RegexWrapper, RouteMethodTable>& item) {
+        [&req](const std::pair<RegexWrapper, RouteMethodTable>& item) {
           if (std::regex_match(req.url, item.first.regex)) {
             return item.second.contains(req.method);
           }
@@ -289,17 +128,16 @@ namespace lime {
       );
 
       if (res == m_regex_routes.end()) {
-        warning(std::format(
+        warning(
           "url '{}' with method '{}' not found",
           req.url,
           to_string(req.method)
-        ));
-        return Response { StatusCode::NotFound }.to_string();
+        );
+        return nullptr;
       }
 
       const auto& method_table { res->second };
-      const auto& func { method_table.at(req.method) };
-      return func(req).to_string();
+      return &method_table.at(req.method);
     }
   } // http
 } // lime
@@ -4,10 +4,17 @@
 #include <sys/socket.h>
 #include <fcntl.h>
 #include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <format>
 #include <functional>
 #include <mutex>
+#include <optional>
+#include <ranges>
+#include <cctype>
 #include <cerrno>
 #include <csignal>
 #include <cstdint>
@@ -15,40 +22,281 @@
 #include <cstdlib>
 #include <cstring>
 #include <thread>
+#include <variant>
+#include <vector>
 #include <lime/lime.h>
+#include <lime/http/parser.h>
+
+#if defined(__linux__)
+  #include <sys/signalfd.h>
+#endif
 
 #ifndef CLIENT_MAX_QUEUE_SIZE
   #define CLIENT_MAX_QUEUE_SIZE 512
 #endif
 
+#ifndef CLIENT_READ_BUFFER_SIZE
+  #define CLIENT_READ_BUFFER_SIZE 4096
+#endif
+
 namespace lime {
   namespace http {
-    namespace signal_handler {
-      struct SignalHandler {
-        std::mutex mut = {};
-        bool close_intp = false;
+    namespace signals {
+    #if defined(__linux__)
+      static sigset_t s_previous {};
+
+      /*
+      * blocks the shutdown signals on the calling thread, which the loop thread
+      * inherits, and reads them through a signalfd
+      */
+      [[nodiscard]]
+      static int open() {
+        sigset_t set {};
+        sigemptyset(&set);
+        sigaddset(&set, SIGINT);
+        sigaddset(&set, SIGTERM);
+
+        if (pthread_sigmask(SIG_BLOCK, &set, &s_previous) != 0) {
+          return -1;
+        }
+        return signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+      }
+
+      [[nodiscard]]
+      static int consume(const int fd) {
+        signalfd_siginfo info {};
+        if (read(fd, &info, sizeof(info)) != sizeof(info)) {
+          return 0;
+        }
+        return static_cast<int>(info.ssi_signo);
+      }
+
+      static void close(const int fd) {
+        ::close(fd);
+      }
+
+      /* unblocks the signals again on the thread which called open() */
+      static void restore() {
+        pthread_sigmask(SIG_SETMASK, &s_previous, nullptr);
+      }
+    #else
+      /* self-pipe, the handler only writes the signal number which is async-signal-safe */
+      static int s_pipe[2] { -1, -1 };
+
+      static void handler(int signo) {
+        const char byte { static_cast<char>(signo) };
+        [[maybe_unused]] const auto _ = write(s_pipe[1], &byte, 1);
+      }
+
+      [[nodiscard]]
+      static int open() {
+        if (pipe(s_pipe) < 0) {
+          return -1;
+        }
+
+        for (const int fd: s_pipe) {
+          fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+          fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+
+        struct sigaction action {};
+        action.sa_handler = handler;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        return s_pipe[0];
+      }
+
+      [[nodiscard]]
+      static int consume(const int fd) {
+        char byte { 0 };
+        if (read(fd, &byte, 1) != 1) {
+          return 0;
+        }
+        return byte;
+      }
+
+      static void close(const int) {
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        for (int& fd: s_pipe) {
+          ::close(fd);
+          fd = -1;
+        }
+      }
+
+      static void restore() {}
+    #endif
+    } // signals
+
+    namespace stats {
+      /* shared by every server in the process */
+      struct Metrics {
+        metrics::Counter&   accepted;
+        metrics::Gauge&     active;
+        metrics::Counter&   bytes_in;
+        metrics::Counter&   bytes_out;
+        metrics::Histogram& read;
+        metrics::Histogram& handler;
+        metrics::Histogram& write;
+        metrics::Counter&   coalesced;
       };
 
-      static SignalHandler instance {};
-      static void handler(int) {
-        info("received shutdown signal");
-        std::lock_guard<std::mutex> guard { signal_handler::instance.mut };
-        signal_handler::instance.close_intp = true;
+      [[nodiscard]]
+      static Metrics& get() {
+        auto& r { metrics::registry() };
+        static Metrics metrics {
+          r.counter("lime_connections_accepted_total", "Connections accepted"),
+          r.gauge("lime_connections_active", "Connections open"),
+          r.counter("lime_received_bytes_total", "Bytes of requests read"),
+          r.counter("lime_sent_bytes_total", "Bytes of responses written"),
+          r.histogram("lime_request_read_seconds", "Time from the first byte of a request until it is parsed", {}, 1e-9),
+          r.histogram("lime_handler_seconds", "Time spent in request handlers", {}, 1e-9),
+          r.histogram("lime_response_write_seconds", "Time writing responses", {}, 1e-9),
+          r.counter("lime_cache_coalesced_total", "Requests answered with the response of an identical request in progress"),
+        };
+        return metrics;
+      }
+
+      [[nodiscard]]
+      static std::array<metrics::Counter*, 5> requests(const Route* route) {
+        std::array<metrics::Counter*, 5> res {};
+        for (size_t i = 0; i < res.size(); i++) {
+          res[i] = &metrics::registry().counter(
+            "lime_requests_total",
+            "Responses sent by route and status class",
+            {
+              { "route", route != nullptr ? route->path : "unmatched" },
+              { "method", route != nullptr ? to_string(route->method) : "" },
+              { "code", std::format("{}xx", i + 1) },
+            }
+          );
+        }
+        return res;
+      }
+    } // stats
+
+    /* what a connection is waiting for, each phase has its own timeout */
+    enum class Phase {
+      Idle,
+      Head,
+      Body,
+      Handling,
+      Writing,
+    };
+
+    /* state of one client connection, only touched on the loop thread */
+    struct Connection {
+      int                fd;
+      sockaddr_in        peer;
+      RequestParser      parser {};
+      std::string        output {};
+      size_t             written = 0;
+      Phase              phase = Phase::Head;
+      EventLoop::TimerId timer = 0;
+      bool               keep_alive = false;
+      bool               closed = false;
+      /* for the access log and metrics */
+      const Route*       route = nullptr;
+      StatusCode         status = StatusCode::Invalid;
+      /* set while the handler runs to fill the cache, see Server::m_filling */
+      std::string        cache_key {};
+    };
+
+    /* a serialized response, the status is kept for the access log */
+    struct Reply {
+      StatusCode  status;
+      std::string data;
+    };
+
+    namespace conditional {
+      [[nodiscard]]
+      static bool successful(const StatusCode& status) {
+        const int code { static_cast<int>(status) };
+        return code >= 200 && code < 300;
+      }
+
+      /* successful responses to GET carry a hash of their body when enabled, unless the handler set a tag */
+      static void tag(const Request& req, Response& res, const bool automatic) {
+        if (automatic && req.method == Method::Get && successful(res.code()) && res.header("ETag") == nullptr) {
+          res.set_etag(etag(res.body()));
+        }
+      }
+
+      /* a 304 keeps the headers of the response it stands for, but has no body */
+      static void strip(Response& res) {
+        res.set_body(std::string {});
+        res.remove_header("Content-Length");
+      }
+
+      /* answers 304 when the client sent the tag of the response back */
+      static void revalidate(const Request& req, Response& res) {
+        if (res.code() == StatusCode::NotModified) {
+          strip(res);
+          return;
+        }
+
+        const std::string* tag { res.header("ETag") };
+        if (req.method == Method::Get && successful(res.code()) && tag != nullptr && req.not_modified(*tag)) {
+          res.set_code(StatusCode::NotModified);
+          strip(res);
+        }
+      }
+    } // conditional
+
+    namespace caching {
+      /* responses setting cookies or marked private belong to one client and are never stored or shared */
+      [[nodiscard]]
+      static bool shared(const Response& res) {
+        if (res.header("Set-Cookie") != nullptr) {
+          return false;
+        }
+
+        const std::string* control { res.header("Cache-Control") };
+        if (control == nullptr) {
+          return true;
+        }
+
+        for (const auto part: std::views::split(std::string_view { *control }, ',')) {
+          std::string_view directive { part.begin(), part.end() };
+          directive = directive.substr(0, directive.find('='));
+          while (!directive.empty() && directive.front() == ' ') {
+            directive.remove_prefix(1);
+          }
+          while (!directive.empty() && directive.back() == ' ') {
+            directive.remove_suffix(1);
+          }
+
+          const auto equals = [&directive](std::string_view name) {
+            return std::ranges::equal(directive, name, [](char a, char b) {
+              return std::tolower(static_cast<unsigned char>(a)) == b;
+            });
+          };
+          if (equals("private") || equals("no-store")) {
+            return false;
+          }
+        }
+        return true;
       }
-    } // signal_handler
+    } // caching
+
+    [[nodiscard]]
+    static Reply serialize(Response res, const bool keep_alive) {
+      res.set_header("Connection", keep_alive ? "keep-alive" : "close");
+      return { res.code(), res.to_string() };
+    }
 
     Server::Server(const Router& router, const size_t max_workers)
+    : Server(router, max_workers, true) {}
+
+    Server::Server(const Router& router, const size_t max_workers, const bool record)
     : m_router(router),
       m_port(8080),
+      m_socket(-1),
       m_addrs("0.0.0.0"),
-      m_pool(DynamicThreadPool { max_workers } )
-    {
-      debug("registering signal interupt handler");
-      if (signal(SIGINT, signal_handler::handler) == SIG_ERR) {
-        perror(strerror(errno));
-        exit(1);
-      }
-    }
+      m_record(record),
+      m_loop(&m_pool),
+      m_pool(DynamicThreadPool { max_workers, record } ) {}
 
     Server& Server::port(const uint16_t& port) {
       m_port = port;
@@ -60,6 +308,21 @@ namespace lime {
       return *this;
     }
 
+    Server& Server::timeouts(const Timeouts& timeouts) {
+      m_timeouts = timeouts;
+      return *this;
+    }
+
+    Server& Server::limits(const Limits& limits) {
+      m_limits = limits;
+      return *this;
+    }
+
+    Server& Server::handle_signals(const bool enable) {
+      m_handle_signals = enable;
+      return *this;
+    }
+
     uint16_t Server::port() const {
       return m_port;
     }
@@ -68,12 +331,88 @@ namespace lime {
       return m_addrs;
     }
 
-    int Server::run() {
-      info(std::format("libhttp version: {}", lime::version::to_string()));
+    const Timeouts& Server::timeouts() const {
+      return m_timeouts;
+    }
+
+    const Limits& Server::limits() const {
+      return m_limits;
+    }
+
+    bool Server::handle_signals() const {
+      return m_handle_signals;
+    }
+
+    Server& Server::access_log(const AccessLog& options) {
+      m_access_log.options(options);
+      return *this;
+    }
+
+    const AccessLog& Server::access_log() const {
+      return m_access_log.options();
+    }
+
+    Server& Server::admin_port(const uint16_t& port) {
+      m_admin_port = port;
+      return *this;
+    }
+
+    uint16_t Server::admin_port() const {
+      if (m_admin) {
+        return m_admin->port();
+      }
+      return m_admin_port.value_or(0);
+    }
+
+    Server& Server::etags(const bool enable) {
+      m_etags = enable;
+      return *this;
+    }
+
+    bool Server::etags() const {
+      return m_etags;
+    }
+
+    Server::~Server() {
+      stop(std::chrono::milliseconds { 0 });
+      if (m_loop_thread.joinable()) {
+        m_loop_thread.join();
+      }
+    }
+
+    int Server::start() {
+      {
+        std::lock_guard lock { m_state_mutex };
+        if (m_running) {
+          errno = EALREADY;
+          return -1;
+        }
+      }
+
+      /* the loop thread of a previous run has already finished */
+      if (m_loop_thread.joinable()) {
+        m_loop_thread.join();
+      }
+
+      info("libhttp version: {}", lime::version::to_string());
 
       int ret { 0 };
       const int optval { 1 };
 
+      /* undoes a partially started server, keeping errno of the failed call */
+      const auto fail = [this](const int ret) {
+        const int saved { errno };
+        if (m_signal_fd >= 0) {
+          m_loop.unwatch(m_signal_fd);
+          signals::close(m_signal_fd);
+          signals::restore();
+          m_signal_fd = -1;
+        }
+        stop_accepting();
+        errno = saved;
+        return ret;
+      };
+
       if (m_socket = socket(AF_INET, SOCK_STREAM, 0); m_socket < 0) {
         return m_socket;
       }
@@ -86,7 +425,7 @@ namespace lime {
         &optval,
         sizeof(optval)
       ); ret < 0) {
-        return ret;
+        return fail(ret);
       }
       debug("set socket options");
 
@@ -108,83 +447,717 @@ namespace lime {
       m_len = sizeof(m_addr);
 
       if (ret = bind(m_socket, (sockaddr*)&m_addr, m_len); ret < 0) {
-        return ret;
+        return fail(ret);
       }
       debug("binded socket to an address");
 
+      /* port 0 lets the kernel pick one, report the real port back */
+      if (ret = getsockname(m_socket, (sockaddr*)&m_addr, &m_len); ret < 0) {
+        return fail(ret);
+      }
+      m_port = ntohs(m_addr.sin_port);
+
       if (ret = listen(m_socket, CLIENT_MAX_QUEUE_SIZE); ret < 0) {
-        return ret;
+        return fail(ret);
       }
       debug("started listening on that address");
 
-      debug("starting accept loop in a separate thread");
-      m_accept_thread = std::jthread([this](std::stop_token stoken) {
-        while (!stoken.stop_requested()) {
-          sockaddr_in addr {};
-          socklen_t len { sizeof(addr) };
-          int client { accept(m_socket, (sockaddr*)&addr, &len) };
-          debug("connected to a client");
-
-          if (client < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-              std::this_thread::sleep_for(std::chrono::milliseconds(10));
-              continue;
-            }
+      if (ret = m_loop.watch(m_socket, EventLoop::Readable, [this](uint32_t) {
+        accept_clients();
+      }); ret < 0) {
+        return fail(ret);
+      }
 
-            if (errno == EBADF || errno == EINVAL) {
-              debug("accept() returned with EBADF/EINVAL");
-              return;
-            }
+      if (m_handle_signals) {
+        debug("registering shutdown signal handler");
+        if (m_signal_fd = signals::open(); m_signal_fd < 0) {
+          return fail(m_signal_fd);
+        }
 
-            error(strerror(errno));
-            continue;
+        if (ret = m_loop.watch(m_signal_fd, EventLoop::Readable, [this](uint32_t) {
+          if (const int signo = signals::consume(m_signal_fd); signo != 0) {
+            info("received shutdown signal: {}", strsignal(signo));
+            drain(m_timeouts.drain);
           }
+        }); ret < 0) {
+          return fail(ret);
+        }
+      }
 
+      if (m_admin_port) {
+        if (!m_admin) {
+          m_admin_router = std::make_unique<Router>();
+          m_admin_router->add_metrics();
+          /* scrapes are not recorded, so they do not show up in the metrics they read */
+          m_admin = std::unique_ptr<Server>(new Server(*m_admin_router, 1, false));
+        }
 
-          debug("enqueuing new client handler into the queue");
-          m_pool.enqueue([router = std::cref(m_router), client = client]() {
-            const std::string res { router.get().handle(client) };
+        if (ret = m_admin->port(*m_admin_port).addrs(m_addrs).start(); ret < 0) {
+          return fail(ret);
+        }
+        debug("serving metrics on port: {}", m_admin->port());
+      }
 
-            write(client, res.c_str(), res.length());
-            debug("sent response to client");
+      {
+        std::lock_guard lock { m_state_mutex };
+        m_running = true;
+        m_draining = false;
+        m_loop_stopping = false;
+        m_report = {};
+        m_result = 0;
+      }
 
-            if (close(client) < 0) {
-              error(strerror(errno));
-              return;
-            }
+      debug("starting event loop in a separate thread");
+      m_loop_thread = std::jthread([this]() {
+        const int ret { m_loop.run() };
+        if (ret < 0) {
+          error("event loop failed: {}", strerror(errno));
+        }
 
-            debug("connection closed with client");
-            return;
-          });
+        info("shutting down");
+        if (m_signal_fd >= 0) {
+          m_loop.unwatch(m_signal_fd);
+          signals::close(m_signal_fd);
+          m_signal_fd = -1;
+        }
 
-          debug("submitted client to a worker in pool");
+        stop_accepting();
+        while (!m_connections.empty()) {
+          close_connection(m_connections.begin()->second, true);
         }
-      });
+        /* the requests waiting for these keys are closed, a fill left behind would hold back the next run */
+        m_filling.clear();
 
-      info(std::format("started server on port: {}", m_port));
+        if (m_admin) {
+          m_admin->stop(std::chrono::milliseconds { 0 });
+          m_admin->wait();
+        }
 
-      while (true) {
-        { /* mutex is scoped to call unlock at the end of scope */
-          std::lock_guard<std::mutex> guard { signal_handler::instance.mut };
-          if(signal_handler::instance.close_intp) break;
+        {
+          std::lock_guard lock { m_state_mutex };
+          m_running = false;
+          m_result = ret;
         }
+        m_state_changed.notify_all();
+      });
+
+      info("started server on port: {}", m_port);
+      return 0;
+    }
+
+    int Server::wait() {
+      {
+        std::unique_lock lock { m_state_mutex };
+        m_state_changed.wait(lock, [this]() {
+          return !m_running;
+        });
+      }
+
+      if (m_loop_thread.joinable() && m_loop_thread.get_id() != std::this_thread::get_id()) {
+        m_loop_thread.join();
+      }
+
+      flush_logs();
+      return m_result;
+    }
+
+    int Server::run() {
+      if (const int ret = start(); ret < 0) {
+        return ret;
+      }
+
+      const int ret { wait() };
+      if (m_handle_signals) {
+        signals::restore();
+      }
+      return ret;
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    DrainReport Server::stop() {
+      return stop(m_timeouts.drain);
+    }
+
+    DrainReport Server::stop(std::chrono::milliseconds deadline) {
+      std::unique_lock lock { m_state_mutex };
+      if (!m_running) {
+        return m_report;
       }
 
-      info("shutting down");
-      m_accept_thread.request_stop();
+      m_loop.post([this, deadline]() {
+        drain(deadline);
+      });
+
+      /* waiting on the loop thread would never let the drain finish */
+      if (EventLoop::current() == &m_loop) {
+        return {};
+      }
 
+      m_state_changed.wait(lock, [this]() {
+        return !m_running;
+      });
+      return m_report;
+    }
+
+    void Server::stop_accepting() {
+      if (m_socket < 0) {
+        return;
+      }
+
+      m_loop.unwatch(m_socket);
       shutdown(m_socket, SHUT_RDWR);
       close(m_socket);
+      m_socket = -1;
+    }
 
-      if (m_accept_thread.joinable()) {
-        m_accept_thread.join();
+    void Server::drain(std::chrono::milliseconds deadline) {
+      if (m_draining) {
+        warning("shutdown requested again, aborting remaining connections");
+        abort_drain();
+        return;
       }
 
-      m_pool.shutdown();
+      info(
+        "draining {} connections, waiting up to {}ms",
+        m_connections.size(),
+        deadline.count()
+      );
+      m_draining = true;
+      stop_accepting();
 
-      return 0;
+      /* connections without a request in progress can go right away */
+      std::vector<std::shared_ptr<Connection>> idle {};
+      for (const auto& [fd, conn]: m_connections) {
+        if (conn->phase == Phase::Idle || (conn->phase == Phase::Head && conn->parser.idle())) {
+          idle.push_back(conn);
+        }
+      }
+
+      for (const auto& conn: idle) {
+        close_connection(conn);
+      }
+
+      if (m_connections.empty()) {
+        finish_drain();
+        return;
+      }
+
+      m_drain_timer = m_loop.add_timer(deadline, [this]() {
+        m_drain_timer = 0;
+        abort_drain();
+      });
+    }
+
+    void Server::abort_drain() {
+      std::vector<std::shared_ptr<Connection>> remaining {};
+      for (const auto& [fd, conn]: m_connections) {
+        remaining.push_back(conn);
+      }
+
+      for (const auto& conn: remaining) {
+        close_connection(conn, true);
+      }
+
+      finish_drain();
+    }
+
+    void Server::finish_drain() {
+      if (m_loop_stopping) {
+        return;
+      }
+
+      m_loop_stopping = true;
+      m_loop.cancel_timer(m_drain_timer);
+      m_drain_timer = 0;
+
+      info(
+        "drained {} connections, aborted {}",
+        m_report.drained,
+        m_report.aborted
+      );
+      m_loop.stop();
+    }
+
+    void Server::accept_clients() {
+      while (true) {
+        sockaddr_in addr {};
+        socklen_t len { sizeof(addr) };
+        const int client { accept(m_socket, (sockaddr*)&addr, &len) };
+
+        if (client < 0) {
+          if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            error(strerror(errno));
+          }
+          return;
+        }
+        debug("connected to a client");
+        if (m_record) {
+          stats::get().accepted.add();
+          stats::get().active.add();
+        }
+
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+
+        const auto conn { std::make_shared<Connection>(client, addr, RequestParser { m_limits }) };
+        conn->parser.request().timings.mark(trace::Phase::Accepted);
+        m_connections.emplace(client, conn);
+        set_phase(conn, Phase::Head);
+        wait_request(conn);
+      }
+    }
+
+    void Server::set_phase(const std::shared_ptr<Connection>& conn, const Phase phase) {
+      m_loop.cancel_timer(conn->timer);
+      conn->timer = 0;
+      conn->phase = phase;
+
+      std::chrono::milliseconds timeout {};
+      switch (phase) {
+        case Phase::Idle:     timeout = m_timeouts.keep_alive; break;
+        case Phase::Head:     timeout = m_timeouts.header_read; break;
+        case Phase::Body:     timeout = m_timeouts.body_read; break;
+        case Phase::Writing:  timeout = m_timeouts.write; break;
+        case Phase::Handling: return;
+      }
+
+      if (timeout.count() <= 0) {
+        return;
+      }
+
+      conn->timer = m_loop.add_timer(timeout, [this, conn]() {
+        conn->timer = 0;
+        expire(conn);
+      });
+    }
+
+    void Server::expire(const std::shared_ptr<Connection>& conn) {
+      switch (conn->phase) {
+        case Phase::Head:
+        case Phase::Body:
+        warning("client {} timed out while sending the request", conn->fd);
+        m_loop.unwatch(conn->fd);
+        conn->keep_alive = false;
+        respond(conn, serialize(Response { StatusCode::RequestTimeout }, false));
+        return;
+
+        case Phase::Writing:
+        warning("client {} timed out while receiving the response", conn->fd);
+        close_connection(conn);
+        return;
+
+        default:
+        debug("closing idle connection");
+        close_connection(conn);
+        return;
+      }
+    }
+
+    void Server::wait_request(const std::shared_ptr<Connection>& conn) {
+      if (m_loop.watch(conn->fd, EventLoop::Readable, [this, conn](uint32_t) {
+        read_request(conn);
+      }) < 0) {
+        error(strerror(errno));
+        close_connection(conn);
+      }
+    }
+
+    void Server::read_request(const std::shared_ptr<Connection>& conn) {
+      thread_local static std::array<char, CLIENT_READ_BUFFER_SIZE> buffer {};
+
+      while (true) {
+        const ssize_t len { read(conn->fd, buffer.data(), buffer.size()) };
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          return;
+        }
+
+        if (len <= 0) {
+          debug("client closed the connection");
+          close_connection(conn);
+          return;
+        }
+        if (m_record) {
+          stats::get().bytes_in.add(static_cast<uint64_t>(len));
+        }
+
+        if (!process(conn, { buffer.data(), static_cast<size_t>(len) })) {
+          return;
+        }
+      }
+    }
+
+    bool Server::process(const std::shared_ptr<Connection>& conn, std::string_view data) {
+      auto& timings { conn->parser.request().timings };
+
+      /* bytes of the next request were just read or are left from the previous one */
+      if (!timings.reached(trace::Phase::Started) && (!data.empty() || !conn->parser.idle())) {
+        timings.mark(trace::Phase::Started);
+      }
+
+      const auto state { conn->parser.feed(data) };
+      if (conn->parser.head_done() && !timings.reached(trace::Phase::HeadRead)) {
+        timings.mark(trace::Phase::HeadRead);
+      }
+
+      switch (state) {
+        case RequestParser::State::Incomplete:
+        if (conn->phase == Phase::Idle && !conn->parser.idle()) {
+          set_phase(conn, Phase::Head);
+        }
+
+        if (conn->phase == Phase::Head && conn->parser.head_done()) {
+          set_phase(conn, Phase::Body);
+        }
+        return true;
+
+        case RequestParser::State::Error:
+        m_loop.unwatch(conn->fd);
+        conn->keep_alive = false;
+        respond(conn, serialize(Response { conn->parser.error() }, false));
+        return false;
+
+        case RequestParser::State::Complete:
+        m_loop.unwatch(conn->fd);
+        conn->keep_alive = conn->parser.keep_alive();
+        timings.mark(trace::Phase::BodyRead);
+        if (m_record) {
+          stats::get().read.record(timings.between(trace::Phase::Started, trace::Phase::BodyRead));
+        }
+        set_phase(conn, Phase::Handling);
+        dispatch(conn);
+        return false;
+      }
+
+      return false;
+    }
+
+    void Server::dispatch(const std::shared_ptr<Connection>& conn) {
+      conn->route = m_router.find(conn->parser.request());
+      conn->parser.request().timings.mark(trace::Phase::Routed);
+      if (conn->route == nullptr) {
+        respond(conn, serialize(Response { StatusCode::NotFound }, conn->keep_alive && !m_draining));
+        return;
+      }
+
+      if (conn->route->cache && serve_cached(conn)) {
+        return;
+      }
+
+      run_handler(conn);
+    }
+
+    void Server::run_handler(const std::shared_ptr<Connection>& conn) {
+      const Handler* handler { &conn->route->handler };
+      if (const auto* func = std::get_if<AsyncRouteFunc>(handler)) {
+        spawn(dispatch_async(conn, *func));
+        return;
+      }
+
+      debug("enqueuing request handler into the pool");
+      m_pool.enqueue([this, conn, func = std::cref(std::get<RouteFunc>(*handler))]() {
+        auto& timings { conn->parser.request().timings };
+        std::optional<Response> response {};
+        timings.mark(trace::Phase::HandlerStarted);
+        try {
+          response.emplace(func.get()(conn->parser.request()));
+        } catch (const std::exception& e) {
+          error("handler threw: {}", e.what());
+          response.emplace(StatusCode::InternalServerError);
+        }
+        timings.mark(trace::Phase::HandlerFinished);
+        if (m_record) {
+          stats::get().handler.record(timings.between(trace::Phase::HandlerStarted, trace::Phase::HandlerFinished));
+        }
+
+        std::shared_ptr<const CachedResponse> cached {};
+        Reply res { complete(conn, std::move(*response), cached) };
+        timings.mark(trace::Phase::Serialized);
+
+        m_loop.post([this, conn, res = std::move(res), cached = std::move(cached)]() mutable {
+          if (!conn->cache_key.empty()) {
+            respond_waiting(conn, std::move(res), cached);
+            return;
+          }
+          respond(conn, std::move(res));
+        });
+      });
+    }
+
+    Task<void> Server::dispatch_async(std::shared_ptr<Connection> conn, const AsyncRouteFunc& func) {
+      auto& timings { conn->parser.request().timings };
+      std::optional<Response> response {};
+      timings.mark(trace::Phase::HandlerStarted);
+      try {
+        response.emplace(co_await func(conn->parser.request()));
+      } catch (const std::exception& e) {
+        error("handler threw: {}", e.what());
+        response.emplace(StatusCode::InternalServerError);
+      }
+      timings.mark(trace::Phase::HandlerFinished);
+      if (m_record) {
+        stats::get().handler.record(timings.between(trace::Phase::HandlerStarted, trace::Phase::HandlerFinished));
+      }
+
+      std::shared_ptr<const CachedResponse> cached {};
+      Reply res { complete(conn, std::move(*response), cached) };
+      if (!conn->cache_key.empty()) {
+        respond_waiting(conn, std::move(res), cached);
+      } else {
+        respond(conn, std::move(res));
+      }
+    }
+
+    Reply Server::complete(const std::shared_ptr<Connection>& conn, Response response, std::shared_ptr<const CachedResponse>& cached) {
+      const Request& req { conn->parser.request() };
+      conditional::tag(req, response, m_etags);
+
+      if (conn->cache_key.empty() || !caching::shared(response)) {
+        conditional::revalidate(req, response);
+        /* checked after the handler so a shutdown during it closes the connection */
+        return serialize(std::move(response), conn->keep_alive && !m_draining);
+      }
+
+      cached = store(conn, std::move(response));
+      return cached_reply(conn, *cached);
+    }
+
+    Reply Server::cached_reply(const std::shared_ptr<Connection>& conn, const CachedResponse& cached) {
+      const bool keep_alive { conn->keep_alive && !m_draining };
+      if (cached.etag.empty() || !conn->parser.request().not_modified(cached.etag)) {
+        return { cached.status, cached.serialize(keep_alive) };
+      }
+
+      Response res { StatusCode::NotModified };
+      res.set_header("ETag", cached.etag);
+      conditional::strip(res);
+      return serialize(std::move(res), keep_alive);
+    }
+
+    bool Server::serve_cached(const std::shared_ptr<Connection>& conn) {
+      std::string key { ResponseCache::key(conn->parser.request(), *conn->route->cache) };
+      if (const auto cached { m_cache.find(key) }) {
+        respond(conn, cached_reply(conn, *cached));
+        return true;
+      }
+
+      /* a handler may answer a conditional request with 304, which others can not share */
+      if (conn->parser.request().header.contains("If-None-Match")) {
+        return false;
+      }
+
+      /* only the first request runs the handler, the others wait for its response */
+      const auto [it, first] { m_filling.try_emplace(std::move(key)) };
+      if (!first) {
+        it->second.push_back(conn);
+        if (m_record) {
+          stats::get().coalesced.add();
+        }
+        return true;
+      }
+
+      conn->cache_key = it->first;
+      return false;
+    }
+
+    std::shared_ptr<const CachedResponse> Server::store(const std::shared_ptr<Connection>& conn, Response response) {
+      static constexpr std::string_view Header { "\nConnection: " };
+
+      const std::string* tag { response.header("ETag") };
+      std::string etag { tag != nullptr && conditional::successful(response.code()) ? *tag : "" };
+
+      /* serialized once for every connection, the Connection header is swapped when one closes */
+      Reply res { serialize(std::move(response), true) };
+      const size_t header { res.data.find(Header) };
+      const auto cached {
+        std::make_shared<const CachedResponse>(CachedResponse {
+          .status = res.status,
+          .data = std::move(res.data),
+          .connection = header != std::string::npos ? header + Header.size() : std::string::npos,
+          .expires = std::chrono::steady_clock::now() + conn->route->cache->ttl,
+          .etag = std::move(etag),
+        })
+      };
+
+      if (conditional::successful(cached->status)) {
+        m_cache.insert(conn->cache_key, cached);
+      }
+      return cached;
+    }
+
+    void Server::respond_waiting(const std::shared_ptr<Connection>& conn, Reply res, const std::shared_ptr<const CachedResponse>& cached) {
+      /* taken out first, a pipelined request answered below may start filling the same key again */
+      auto waiting { m_filling.extract(conn->cache_key) };
+      conn->cache_key.clear();
+      respond(conn, std::move(res));
+
+      if (waiting.empty()) {
+        return;
+      }
+
+      for (const auto& other: waiting.mapped()) {
+        /* a response meant for one client is not handed to the others, they run the handler themselves */
+        if (!cached) {
+          run_handler(other);
+          continue;
+        }
+        respond(other, cached_reply(other, *cached));
+      }
+    }
+
+    ResponseCache& Server::cache() {
+      return m_cache;
+    }
+
+    void Server::respond(const std::shared_ptr<Connection>& conn, Reply res) {
+      if (conn->closed) {
+        return;
+      }
+
+      conn->status = res.status;
+      conn->output = std::move(res.data);
+      /* responses made on the loop thread are serialized right before */
+      auto& timings { conn->parser.request().timings };
+      if (!timings.reached(trace::Phase::Serialized)) {
+        timings.mark(trace::Phase::Serialized);
+      }
+
+      count_request(conn);
+      conn->written = 0;
+      set_phase(conn, Phase::Writing);
+      write_response(conn);
+    }
+
+    void Server::write_response(const std::shared_ptr<Connection>& conn) {
+      while (conn->written < conn->output.size()) {
+        const ssize_t len {
+          write(
+            conn->fd,
+            conn->output.data() + conn->written,
+            conn->output.size() - conn->written
+          )
+        };
+
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          if (m_loop.watch(conn->fd, EventLoop::Writable, [this, conn](uint32_t) {
+            write_response(conn);
+          }) < 0) {
+            error(strerror(errno));
+            close_connection(conn);
+          }
+          return;
+        }
+
+        if (len < 0) {
+          error(strerror(errno));
+          close_connection(conn);
+          return;
+        }
+
+        conn->written += len;
+        if (m_record) {
+          stats::get().bytes_out.add(static_cast<uint64_t>(len));
+        }
+      }
+
+      debug("sent response to client");
+      auto& timings { conn->parser.request().timings };
+      timings.mark(trace::Phase::Written);
+      if (m_record) {
+        stats::get().write.record(timings.between(trace::Phase::Serialized, trace::Phase::Written));
+      }
+      log_access(conn);
+      if (trace::enabled()) {
+        const Request& req { conn->parser.request() };
+        trace::record({
+          .timings = timings,
+          .name = to_string(req.method) + " " + req.url,
+          .status = static_cast<int>(conn->status),
+          .track = conn->fd,
+        });
+      }
+
+      if (!conn->keep_alive || m_draining) {
+        close_connection(conn);
+        return;
+      }
+
+      /* the next request may already be buffered when the client pipelines */
+      conn->output.clear();
+      conn->route = nullptr;
+      conn->parser.reset();
+      set_phase(conn, Phase::Idle);
+      if (process(conn, {})) {
+        wait_request(conn);
+      }
+    }
+
+    void Server::log_access(const std::shared_ptr<Connection>& conn) {
+      if (!m_access_log.options().enabled) {
+        return;
+      }
+
+      /* a request timing out before its first byte counts from the accept */
+      const auto& timings { conn->parser.request().timings };
+      const auto first { timings.reached(trace::Phase::Started) ? trace::Phase::Started : trace::Phase::Accepted };
+      const auto latency {
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.between(first, trace::Phase::Written))
+      };
+
+      if (!m_access_log.wants(latency)) {
+        return;
+      }
+
+      const Request& req { conn->parser.request() };
+      m_access_log.log({
+        .method = req.method,
+        .path = req.url,
+        .status = conn->status,
+        .bytes = conn->output.size(),
+        .latency = latency,
+        .peer = conn->peer,
+        .time = std::chrono::system_clock::now(),
+      });
+    }
+
+    void Server::count_request(const std::shared_ptr<Connection>& conn) {
+      if (!m_record) {
+        return;
+      }
+
+      auto it { m_requests.find(conn->route) };
+      if (it == m_requests.end()) {
+        it = m_requests.emplace(conn->route, stats::requests(conn->route)).first;
+      }
+
+      const int code { static_cast<int>(conn->status) };
+      it->second[std::clamp(code / 100 - 1, 0, 4)]->add();
+    }
+
+    void Server::close_connection(std::shared_ptr<Connection> conn, const bool aborted) {
+      if (conn->closed) {
+        return;
+      }
+
+      conn->closed = true;
+      m_loop.cancel_timer(conn->timer);
+      m_loop.unwatch(conn->fd);
+      m_connections.erase(conn->fd);
+      if (m_record) {
+        stats::get().active.sub();
+      }
+
+      if (close(conn->fd) < 0) {
+        error(strerror(errno));
+      } else {
+        debug("connection closed with client");
+      }
+
+      if (!m_draining) {
+        return;
+      }
+
+      (aborted ? m_report.aborted : m_report.drained)++;
+      if (m_connections.empty()) {
+        finish_drain();
+      }
     }
   } // http
 } // lime
@@ -0,0 +1,408 @@
+#include <stdexcept>
+#include <variant>
+#include <lime/json/document.h>
+#include <lime/json/escape.h>
+#include <lime/json/parser.h>
+#include <lime/json/reader.h>
+
+namespace lime {
+  namespace json {
+    /* appends values to the flat element array while following the tokens */
+    class DocumentBuilder {
+    public:
+      DocumentBuilder(Document& doc, Scanner& sc)
+      : m_doc(doc), m_sc(sc) {}
+
+      [[nodiscard]]
+      std::expected<void, std::string> build();
+
+    private:
+      [[nodiscard]]
+      std::expected<Token, std::string> next();
+      [[nodiscard]]
+      std::expected<void, std::string> value(const Token&, size_t depth);
+      [[nodiscard]]
+      std::expected<void, std::string> array(size_t depth);
+      [[nodiscard]]
+      std::expected<void, std::string> object(size_t depth);
+      void string();
+
+      Document& m_doc;
+      Scanner&  m_sc;
+    };
+
+    std::expected<Token, std::string> DocumentBuilder::next() {
+      return m_sc.token();
+    }
+
+    void DocumentBuilder::string() {
+      const std::string_view str { m_sc.get<std::string_view>() };
+
+      Document::Element element { .type = NodeType::String, .size = static_cast<uint32_t>(str.length()), .integer = 0 };
+      element.string.offset = static_cast<uint32_t>(str.data() - m_doc.m_data.data());
+      element.string.escaped = m_sc.escaped();
+      m_doc.m_elements.push_back(element);
+    }
+
+    /* depth counts the arrays and objects around the value, it bounds the recursion like json::Reader bounds its stack */
+    std::expected<void, std::string> DocumentBuilder::value(const Token& token, size_t depth) {
+      auto& elements { m_doc.m_elements };
+      if ((token == Token::LeftBrace || token == Token::LeftBracket) && depth >= JSON_READER_MAX_DEPTH) {
+        return fmterror("nesting too deep", m_sc.location());
+      }
+
+      switch (token) {
+        case Token::LeftBrace:
+        return object(depth + 1);
+
+        case Token::LeftBracket:
+        return array(depth + 1);
+
+        case Token::Int:
+        elements.push_back({ .type = NodeType::Int, .size = 0, .integer = m_sc.get<int64_t>() });
+        return {};
+
+        case Token::Float:
+        elements.push_back({ .type = NodeType::Float, .size = 0, .floating = m_sc.get<double>() });
+        return {};
+
+        case Token::Bool:
+        elements.push_back({ .type = NodeType::Bool, .size = 0, .boolean = m_sc.get<bool>() });
+        return {};
+
+        case Token::String:
+        string();
+        return {};
+
+        default:
+        return fmterror("expected a literal", m_sc.location());
+      }
+    }
+
+    std::expected<void, std::string> DocumentBuilder::array(size_t depth) {
+      auto& elements { m_doc.m_elements };
+      const size_t pos { elements.size() };
+      elements.push_back({ .type = NodeType::Array, .size = 0, .end = 0 });
+
+      auto token { next() };
+      if (!token) {
+        return std::unexpected(token.error());
+      }
+
+      uint32_t count { 0 };
+      while (*token != Token::RightBracket) {
+        if (const auto ret = value(*token, depth); !ret) {
+          return ret;
+        }
+        count++;
+
+        if (!(token = next())) {
+          return std::unexpected(token.error());
+        }
+
+        if (*token == Token::RightBracket) {
+          break;
+        }
+
+        if (*token != Token::Comma) {
+          return fmterror("expected ',' or ']'", m_sc.location());
+        }
+
+        if (!(token = next())) {
+          return std::unexpected(token.error());
+        }
+      }
+
+      elements[pos].size = count;
+      elements[pos].end = static_cast<uint32_t>(elements.size());
+      return {};
+    }
+
+    std::expected<void, std::string> DocumentBuilder::object(size_t depth) {
+      auto& elements { m_doc.m_elements };
+      const size_t pos { elements.size() };
+      elements.push_back({ .type = NodeType::Object, .size = 0, .end = 0 });
+
+      auto token { next() };
+      if (!token) {
+        return std::unexpected(token.error());
+      }
+
+      uint32_t count { 0 };
+      while (*token != Token::RightBrace) {
+        if (*token != Token::String) {
+          return fmterror("expected 'string' literal", m_sc.location());
+        }
+        string();
+
+        if (!(token = next())) {
+          return std::unexpected(token.error());
+        }
+
+        if (*token != Token::Colon) {
+          return fmterror("expected ':'", m_sc.location());
+        }
+
+        if (!(token = next())) {
+          return std::unexpected(token.error());
+        }
+
+        if (const auto ret = value(*token, depth); !ret) {
+          return ret;
+        }
+        count++;
+
+        if (!(token = next())) {
+          return std::unexpected(token.error());
+        }
+
+        if (*token == Token::RightBrace) {
+          break;
+        }
+
+        if (*token != Token::Comma) {
+          return fmterror("expected ',' or '}'", m_sc.location());
+        }
+
+        if (!(token = next())) {
+          return std::unexpected(token.error());
+        }
+      }
+
+      elements[pos].size = count;
+      elements[pos].end = static_cast<uint32_t>(elements.size());
+      return {};
+    }
+
+    std::expected<void, std::string> DocumentBuilder::build() {
+      /* every element starts at a token, so this is the only allocation */
+      m_doc.m_elements.reserve(m_sc.remaining());
+
+      auto token { next() };
+      if (!token) {
+        return std::unexpected(token.error());
+      }
+
+      if (const auto ret = value(*token, 0); !ret) {
+        return ret;
+      }
+
+      if (!(token = next())) {
+        return std::unexpected(token.error());
+      }
+
+      if (*token != Token::EndOfFile) {
+        return fmterror("expected end of file", m_sc.location());
+      }
+
+      return {};
+    }
+
+    Document::Document(std::string_view data)
+    : m_data(data) {}
+
+    std::expected<Document, std::string> Document::parse(std::string_view data) {
+      Document doc { data };
+      Scanner scanner { data };
+      DocumentBuilder builder { doc, scanner };
+
+      if (const auto ret = builder.build(); !ret) {
+        return std::unexpected(ret.error());
+      }
+
+      return doc;
+    }
+
+    Value Document::root() const {
+      return Value { this, 0 };
+    }
+
+    Value::Value(const Document* doc, uint32_t pos)
+    : m_doc(doc), m_pos(pos) {}
+
+    NodeType Value::type() const {
+      return m_doc->m_elements[m_pos].type;
+    }
+
+    uint32_t Value::next() const {
+      const auto& element { m_doc->m_elements[m_pos] };
+      if (element.type == NodeType::Array || element.type == NodeType::Object) {
+        return element.end;
+      }
+      return m_pos + 1;
+    }
+
+    std::string_view Value::string() const {
+      const auto& element { m_doc->m_elements[m_pos] };
+      if (!element.string.escaped) {
+        return m_doc->m_data.substr(element.string.offset, element.size);
+      }
+
+      auto it { m_doc->m_unescaped.find(m_pos) };
+      if (it == m_doc->m_unescaped.end()) {
+        it = m_doc->m_unescaped.emplace(
+          m_pos,
+          unescape(m_doc->m_data.substr(element.string.offset, element.size))
+        ).first;
+      }
+      return it->second;
+    }
+
+    template <>
+    int64_t Value::get<int64_t>() const {
+      if (type() != NodeType::Int) {
+        throw std::bad_variant_access {};
+      }
+      return m_doc->m_elements[m_pos].integer;
+    }
+
+    template <>
+    double Value::get<double>() const {
+      if (type() != NodeType::Float) {
+        throw std::bad_variant_access {};
+      }
+      return m_doc->m_elements[m_pos].floating;
+    }
+
+    template <>
+    bool Value::get<bool>() const {
+      if (type() != NodeType::Bool) {
+        throw std::bad_variant_access {};
+      }
+      return m_doc->m_elements[m_pos].boolean;
+    }
+
+    template <>
+    std::string_view Value::get<std::string_view>() const {
+      if (type() != NodeType::String) {
+        throw std::bad_variant_access {};
+      }
+      return string();
+    }
+
+    size_t Value::size() const {
+      const auto& element { m_doc->m_elements[m_pos] };
+      if (element.type == NodeType::Array || element.type == NodeType::Object) {
+        return element.size;
+      }
+      return 0;
+    }
+
+    Value Value::operator[](size_t i) const {
+      if (type() != NodeType::Array || i >= size()) {
+        throw std::out_of_range { "json array index out of range" };
+      }
+
+      Iterator it { m_doc, m_pos + 1 };
+      while (i-- > 0) {
+        ++it;
+      }
+      return *it;
+    }
+
+    std::optional<Value> Value::find(std::string_view key) const {
+      if (type() != NodeType::Object) {
+        return std::nullopt;
+      }
+
+      for (const auto& member: members()) {
+        if (member.key == key) {
+          return member.value;
+        }
+      }
+      return std::nullopt;
+    }
+
+    bool Value::contains(std::string_view key) const {
+      return find(key).has_value();
+    }
+
+    Value Value::at(std::string_view key) const {
+      const auto value { find(key) };
+      if (!value) {
+        throw std::out_of_range { "json object has no such key" };
+      }
+      return *value;
+    }
+
+    Value::Range<Value::Iterator> Value::elements() const {
+      if (type() != NodeType::Array) {
+        return { { m_doc, m_pos }, { m_doc, m_pos } };
+      }
+      return { { m_doc, m_pos + 1 }, { m_doc, m_doc->m_elements[m_pos].end } };
+    }
+
+    Value::Range<Value::MemberIterator> Value::members() const {
+      if (type() != NodeType::Object) {
+        return { { m_doc, m_pos }, { m_doc, m_pos } };
+      }
+      return { { m_doc, m_pos + 1 }, { m_doc, m_doc->m_elements[m_pos].end } };
+    }
+
+    Node Value::to_node() const {
+      switch (type()) {
+        case NodeType::Int:
+        return get<int64_t>();
+
+        case NodeType::Float:
+        return get<double>();
+
+        case NodeType::Bool:
+        return get<bool>();
+
+        case NodeType::String:
+        return std::string { string() };
+
+        case NodeType::Array: {
+          Array array {};
+          array.reserve(size());
+          for (const auto value: elements()) {
+            array.emplace_back(value.to_node());
+          }
+          return array;
+        }
+
+        case NodeType::Object: {
+          Object object {};
+          object.reserve(size());
+          for (const auto& [key, value]: members()) {
+            /* the first of repeated keys wins, like in json::decode */
+            object.emplace(key, value.to_node());
+          }
+          return object;
+        }
+
+        default:
+        return Object {};
+      }
+    }
+
+    Value::Iterator::Iterator(const Document* doc, uint32_t pos)
+    : m_doc(doc), m_pos(pos) {}
+
+    Value Value::Iterator::operator*() const {
+      return Value { m_doc, m_pos };
+    }
+
+    Value::Iterator& Value::Iterator::operator++() {
+      m_pos = Value { m_doc, m_pos }.next();
+      return *this;
+    }
+
+    Value::MemberIterator::MemberIterator(const Document* doc, uint32_t pos)
+    : m_doc(doc), m_pos(pos) {}
+
+    /* members are stored as a key string followed by the value */
+    Value::Member Value::MemberIterator::operator*() const {
+      return Member {
+        .key = Value { m_doc, m_pos }.string(),
+        .value = Value { m_doc, m_pos + 1 },
+      };
+    }
+
+    Value::MemberIterator& Value::MemberIterator::operator++() {
+      m_pos = Value { m_doc, m_pos + 1 }.next();
+      return *this;
+    }
+  } // json
+} // lime
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <lime/json/escape.h>
+#include <lime/json/index.h>
+
+namespace lime {
+  namespace json {
+    namespace utf8 {
+      static void append(std::string& out, const uint32_t cp) {
+        if (cp < 0x80) {
+          out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+          out += static_cast<char>(0xC0 | (cp >> 6));
+          out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+          out += static_cast<char>(0xE0 | (cp >> 12));
+          out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+          out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+          out += static_cast<char>(0xF0 | (cp >> 18));
+          out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+          out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+          out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+      }
+
+      /*
+      * length of the well formed sequence starting at pos or 0, rejecting
+      * overlong forms, surrogates and code points past U+10FFFF (RFC 3629)
+      */
+      [[nodiscard]]
+      static size_t sequence(std::string_view str, size_t pos) {
+        const auto byte = [&str](size_t i) {
+          return i < str.length() ? static_cast<unsigned char>(str[i]) : static_cast<unsigned char>(0);
+        };
+
+        const unsigned char lead { byte(pos) };
+        size_t length { 0 };
+        unsigned char low { 0x80 }, high { 0xBF };
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+          length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+          length = 3;
+          low = lead == 0xE0 ? 0xA0 : 0x80;
+          high = lead == 0xED ? 0x9F : 0xBF;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+          length = 4;
+          low = lead == 0xF0 ? 0x90 : 0x80;
+          high = lead == 0xF4 ? 0x8F : 0xBF;
+        } else {
+          return 0;
+        }
+
+        if (byte(pos + 1) < low || byte(pos + 1) > high) {
+          return 0;
+        }
+
+        for (size_t i = 2; i < length; i++) {
+          if (byte(pos + i) < 0x80 || byte(pos + i) > 0xBF) {
+            return 0;
+          }
+        }
+        return length;
+      }
+    } // utf8
+
+    namespace utf16 {
+      [[nodiscard]]
+      static bool is_high(uint32_t unit) {
+        return unit >= 0xD800 && unit <= 0xDBFF;
+      }
+
+      [[nodiscard]]
+      static bool is_low(uint32_t unit) {
+        return unit >= 0xDC00 && unit <= 0xDFFF;
+      }
+
+      /* the 4 hex digits of a \u escape starting at pos, or -1 */
+      [[nodiscard]]
+      static int32_t unit(std::string_view str, size_t pos) {
+        if (pos + 4 > str.length()) {
+          return -1;
+        }
+
+        uint32_t res { 0 };
+        const char* begin { str.data() + pos };
+        if (const auto [ptr, ec] = std::from_chars(begin, begin + 4, res, 16);
+          ec != std::errc {} || ptr != begin + 4) {
+            return -1;
+          }
+        return static_cast<int32_t>(res);
+      }
+
+      /* a \u escape of a low surrogate following a high one at pos, or -1 */
+      [[nodiscard]]
+      static int32_t low(std::string_view str, size_t pos) {
+        if (str.substr(pos, 2) != "\\u") {
+          return -1;
+        }
+
+        const int32_t res { unit(str, pos + 2) };
+        return is_low(res) ? res : -1;
+      }
+    } // utf16
+
+    std::expected<bool, InvalidString> validate(std::string_view str) {
+      const auto fail = [](size_t offset, std::string_view reason) {
+        return std::unexpected(InvalidString { offset, reason });
+      };
+
+      bool escaped { false };
+      size_t pos { 0 };
+      while (true) {
+        /* plain ASCII runs, usually the whole string, are skipped at once */
+        pos += find_special(str.substr(pos));
+        if (pos >= str.length()) {
+          return escaped;
+        }
+
+        const auto c { static_cast<unsigned char>(str[pos]) };
+        if (c == '\\') {
+          escaped = true;
+          switch (pos + 1 < str.length() ? str[pos + 1] : '\0') {
+            case '"': case '\\': case '/':
+            case 'b': case 'f': case 'n': case 'r': case 't':
+            pos += 2;
+            continue;
+
+            case 'u': {
+              const int32_t unit { utf16::unit(str, pos + 2) };
+              if (unit < 0) {
+                return fail(pos, "invalid unicode escape");
+              }
+
+              if (utf16::is_low(unit) || (utf16::is_high(unit) && utf16::low(str, pos + 6) < 0)) {
+                return fail(pos, "unpaired surrogate");
+              }
+
+              pos += utf16::is_high(unit) ? 12 : 6;
+              continue;
+            }
+
+            default:
+            return fail(pos, "invalid escape sequence");
+          }
+        }
+
+        if (c < 0x20) {
+          return fail(pos, "control character in string");
+        }
+
+        if (c == '"') {
+          return fail(pos, "unescaped quote in string");
+        }
+
+        const size_t length { utf8::sequence(str, pos) };
+        if (length == 0) {
+          return fail(pos, "invalid utf-8");
+        }
+        pos += length;
+      }
+    }
+
+    std::string unescape(std::string_view str) {
+      std::string res {};
+      res.reserve(str.length());
+
+      size_t pos { 0 };
+      while (pos < str.length()) {
+        /* stops at backslashes, the only special bytes left in valid contents */
+        const size_t slash { pos + find_escape(str.substr(pos)) };
+        res.append(str.substr(pos, slash - pos));
+        if (slash >= str.length()) {
+          break;
+        }
+
+        if (str[slash] != '\\' || slash + 1 >= str.length()) {
+          res += str[slash];
+          pos = slash + 1;
+          continue;
+        }
+
+        pos = slash + 2;
+        switch (str[slash + 1]) {
+          case '"':  res += '"';  break;
+          case '\\': res += '\\'; break;
+          case '/':  res += '/';  break;
+          case 'b':  res += '\b'; break;
+          case 'f':  res += '\f'; break;
+          case 'n':  res += '\n'; break;
+          case 'r':  res += '\r'; break;
+          case 't':  res += '\t'; break;
+
+          case 'u': {
+            const int32_t unit { utf16::unit(str, pos) };
+            if (unit < 0) {
+              res.append(str.substr(slash, 2));
+              break;
+            }
+
+            pos += 4;
+            uint32_t cp { static_cast<uint32_t>(unit) };
+            if (utf16::is_high(cp)) {
+              if (const int32_t low { utf16::low(str, pos) }; low >= 0) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (static_cast<uint32_t>(low) - 0xDC00);
+                pos += 6;
+              } else {
+                cp = 0xFFFD;
+              }
+            } else if (utf16::is_low(cp)) {
+              cp = 0xFFFD;
+            }
+
+            utf8::append(res, cp);
+            break;
+          }
+
+          default:
+          res.append(str.substr(slash, 2));
+          break;
+        }
+      }
+
+      return res;
+    }
+
+    void escape(std::string_view str, std::string& out) {
+      static constexpr char hex[] { "0123456789abcdef" };
+
+      out += '"';
+      while (!str.empty()) {
+        /* clean runs, usually the whole string, are copied at once */
+        const size_t clean { find_escape(str) };
+        out.append(str.data(), clean);
+        if (clean == str.length()) {
+          break;
+        }
+
+        const char c { str[clean] };
+        switch (c) {
+          case '"':  out += "\\\""; break;
+          case '\\': out += "\\\\"; break;
+          case '\b': out += "\\b"; break;
+          case '\f': out += "\\f"; break;
+          case '\n': out += "\\n"; break;
+          case '\r': out += "\\r"; break;
+          case '\t': out += "\\t"; break;
+
+          default: {
+            const char code[] { '\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF] };
+            out.append(code, sizeof(code));
+            break;
+          }
+        }
+        str.remove_prefix(clean + 1);
+      }
+      out += '"';
+    }
+  } // json
+} // lime
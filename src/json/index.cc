@@ -0,0 +1,368 @@
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <lime/json/index.h>
+
+#ifndef JSON_SIMD
+  /* set to 0 to always build the index with the scalar classifier */
+  #define JSON_SIMD 1
+#endif
+
+#if JSON_SIMD && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  #define JSON_SIMD_X86 1
+  #include <immintrin.h>
+#else
+  #define JSON_SIMD_X86 0
+#endif
+
+namespace lime {
+  namespace json {
+    namespace classify {
+      static constexpr size_t BlockSize = 64;
+
+      /* one bit per byte of a 64 byte block */
+      struct Block {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t op;
+        uint64_t space;
+        uint64_t newline;
+      };
+
+      using Classifier = Block (*)(const char*);
+
+      enum Class : uint8_t {
+        Quote     = 1,
+        Backslash = 2,
+        Op        = 4,
+        Space     = 8,
+        Newline   = 16,
+      };
+
+      static constexpr std::array<uint8_t, 256> table = [] {
+        std::array<uint8_t, 256> res {};
+        res['"'] = Quote;
+        res['\\'] = Backslash;
+        for (const char c: { '{', '}', '[', ']', ':', ',' }) {
+          res[static_cast<uint8_t>(c)] = Op;
+        }
+        for (const char c: { ' ', '\t', '\r' }) {
+          res[static_cast<uint8_t>(c)] = Space;
+        }
+        res['\n'] = Space | Newline;
+        return res;
+      }();
+
+      [[nodiscard]]
+      static Block scalar(const char* data) {
+        Block res {};
+        for (size_t i = 0; i < BlockSize; i++) {
+          const uint64_t c { table[static_cast<uint8_t>(data[i])] };
+          res.quote |= (c & Quote) << i;
+          res.backslash |= ((c & Backslash) >> 1) << i;
+          res.op |= ((c & Op) >> 2) << i;
+          res.space |= ((c & Space) >> 3) << i;
+          res.newline |= ((c & Newline) >> 4) << i;
+        }
+        return res;
+      }
+
+    #if JSON_SIMD_X86
+      /*
+      * whitespace and operators have distinct low nibbles, so a byte is one of them
+      * when the table entry picked by its low nibble equals the byte itself.
+      * '[' and ']' differ from '{' and '}' by 0x20 and are folded onto them,
+      * control characters are excluded as folding them would hit ',' and ':'.
+      */
+      #define JSON_SPACE_TABLE \
+        ' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0
+      #define JSON_OP_TABLE \
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0
+
+      [[nodiscard]]
+      __attribute__((target("sse4.2")))
+      static uint64_t mask(const __m128i v, const size_t shift) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(v))) << shift;
+      }
+
+      [[nodiscard]]
+      __attribute__((target("avx2")))
+      static uint64_t mask(const __m256i v, const size_t shift) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v))) << shift;
+      }
+
+      [[nodiscard]]
+      __attribute__((target("sse4.2")))
+      static Block sse42(const char* data) {
+        const __m128i space_table { _mm_setr_epi8(JSON_SPACE_TABLE) };
+        const __m128i op_table { _mm_setr_epi8(JSON_OP_TABLE) };
+
+        Block res {};
+        for (size_t i = 0; i < BlockSize; i += 16) {
+          const __m128i in { _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)) };
+          res.quote |= mask(_mm_cmpeq_epi8(in, _mm_set1_epi8('"')), i);
+          res.backslash |= mask(_mm_cmpeq_epi8(in, _mm_set1_epi8('\\')), i);
+          res.newline |= mask(_mm_cmpeq_epi8(in, _mm_set1_epi8('\n')), i);
+          res.space |= mask(_mm_cmpeq_epi8(_mm_shuffle_epi8(space_table, in), in), i);
+          res.op |= mask(_mm_and_si128(
+            _mm_cmpeq_epi8(_mm_shuffle_epi8(op_table, in), _mm_or_si128(in, _mm_set1_epi8(0x20))),
+            _mm_cmpgt_epi8(in, _mm_set1_epi8(0x20))
+          ), i);
+        }
+        return res;
+      }
+
+      [[nodiscard]]
+      __attribute__((target("avx2")))
+      static Block avx2(const char* data) {
+        const __m256i space_table { _mm256_setr_epi8(JSON_SPACE_TABLE, JSON_SPACE_TABLE) };
+        const __m256i op_table { _mm256_setr_epi8(JSON_OP_TABLE, JSON_OP_TABLE) };
+
+        Block res {};
+        for (size_t i = 0; i < BlockSize; i += 32) {
+          const __m256i in { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)) };
+          res.quote |= mask(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('"')), i);
+          res.backslash |= mask(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('\\')), i);
+          res.newline |= mask(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('\n')), i);
+          res.space |= mask(_mm256_cmpeq_epi8(_mm256_shuffle_epi8(space_table, in), in), i);
+          res.op |= mask(_mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_shuffle_epi8(op_table, in), _mm256_or_si256(in, _mm256_set1_epi8(0x20))),
+            _mm256_cmpgt_epi8(in, _mm256_set1_epi8(0x20))
+          ), i);
+        }
+        return res;
+      }
+
+      #undef JSON_SPACE_TABLE
+      #undef JSON_OP_TABLE
+    #endif
+
+      [[nodiscard]]
+      static Classifier select(const Isa& isa) {
+      #if JSON_SIMD_X86
+        switch (isa) {
+          case Isa::AVX2:  return avx2;
+          case Isa::SSE42: return sse42;
+          default:         break;
+        }
+      #endif
+        (void)isa;
+        return scalar;
+      }
+    } // classify
+
+    namespace escape {
+      /* with Ascii set bytes of multi-byte UTF-8 sequences are reported too */
+      template <bool Ascii>
+      [[nodiscard]]
+      static bool needed(const char c) {
+        const auto byte { static_cast<unsigned char>(c) };
+        return c == '"' || c == '\\' || byte < 0x20 || (Ascii && byte >= 0x80);
+      }
+
+      template <bool Ascii>
+      [[nodiscard]]
+      static size_t scalar(std::string_view data, size_t pos) {
+        while (pos < data.size() && !needed<Ascii>(data[pos])) {
+          pos++;
+        }
+        return pos;
+      }
+
+    #if JSON_SIMD_X86
+      /* control characters are the bytes left unchanged by an unsigned min with 0x1F */
+      template <bool Ascii>
+      [[nodiscard]]
+      __attribute__((target("sse4.2")))
+      static size_t sse42(std::string_view data) {
+        size_t pos { 0 };
+        for (; pos + 16 <= data.size(); pos += 16) {
+          const __m128i in { _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + pos)) };
+          const __m128i hit {
+            _mm_or_si128(
+              _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('"')), _mm_cmpeq_epi8(in, _mm_set1_epi8('\\'))),
+              _mm_cmpeq_epi8(_mm_min_epu8(in, _mm_set1_epi8(0x1F)), in)
+            )
+          };
+
+          if (const int mask = _mm_movemask_epi8(hit) | (Ascii ? _mm_movemask_epi8(in) : 0); mask != 0) {
+            return pos + std::countr_zero(static_cast<uint32_t>(mask));
+          }
+        }
+        return scalar<Ascii>(data, pos);
+      }
+
+      template <bool Ascii>
+      [[nodiscard]]
+      __attribute__((target("avx2")))
+      static size_t avx2(std::string_view data) {
+        size_t pos { 0 };
+        for (; pos + 32 <= data.size(); pos += 32) {
+          const __m256i in { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + pos)) };
+          const __m256i hit {
+            _mm256_or_si256(
+              _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(in, _mm256_set1_epi8('\\'))),
+              _mm256_cmpeq_epi8(_mm256_min_epu8(in, _mm256_set1_epi8(0x1F)), in)
+            )
+          };
+
+          if (const int mask = _mm256_movemask_epi8(hit) | (Ascii ? _mm256_movemask_epi8(in) : 0); mask != 0) {
+            return pos + std::countr_zero(static_cast<uint32_t>(mask));
+          }
+        }
+        return scalar<Ascii>(data, pos);
+      }
+    #endif
+
+      template <bool Ascii>
+      [[nodiscard]]
+      static size_t find(std::string_view data, const Isa& isa) {
+      #if JSON_SIMD_X86
+        switch (isa) {
+          case Isa::AVX2:  return avx2<Ascii>(data);
+          case Isa::SSE42: return sse42<Ascii>(data);
+          default:         break;
+        }
+      #endif
+        (void)isa;
+        return scalar<Ascii>(data, 0);
+      }
+    } // escape
+
+    namespace bits {
+      /* bit i is the xor of bits 0..i, turning quote positions into string ranges */
+      [[nodiscard]]
+      static uint64_t prefix_xor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+      }
+
+      /*
+      * characters preceded by an odd run of backslashes, carry is set
+      * when the block ends in the middle of such a run
+      */
+      [[nodiscard]]
+      static uint64_t escaped(uint64_t backslash, uint64_t& carry) {
+        constexpr uint64_t even { 0x5555555555555555ULL };
+
+        backslash &= ~carry;
+        const uint64_t follows_escape { (backslash << 1) | carry };
+        const uint64_t odd_starts { backslash & ~even & ~follows_escape };
+
+        uint64_t even_runs {};
+        carry = __builtin_add_overflow(odd_starts, backslash, &even_runs);
+        return (even ^ (even_runs << 1)) & follows_escape;
+      }
+    } // bits
+
+    size_t find_escape(std::string_view data, const Isa& isa) {
+      return escape::find<false>(data, isa);
+    }
+
+    size_t find_special(std::string_view data, const Isa& isa) {
+      return escape::find<true>(data, isa);
+    }
+
+    std::string to_string(const Isa& isa) {
+      switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE42:  return "sse4.2";
+        case Isa::AVX2:   return "avx2";
+        default:          return {};
+      }
+    }
+
+    bool supported(const Isa& isa) {
+    #if JSON_SIMD_X86
+      switch (isa) {
+        case Isa::AVX2:  return __builtin_cpu_supports("avx2");
+        case Isa::SSE42: return __builtin_cpu_supports("sse4.2");
+        default:         break;
+      }
+    #endif
+      return isa == Isa::Scalar;
+    }
+
+    Isa best_isa() {
+      static const Isa isa {
+        supported(Isa::AVX2) ? Isa::AVX2 :
+        supported(Isa::SSE42) ? Isa::SSE42 :
+        Isa::Scalar
+      };
+      return isa;
+    }
+
+    StructuralIndex::StructuralIndex(std::string_view data, const Isa& isa) {
+      if (data.size() > std::numeric_limits<uint32_t>::max()) {
+        return;
+      }
+
+      const classify::Classifier classifier {
+        classify::select(supported(isa) ? isa : Isa::Scalar)
+      };
+
+      /* every byte can start a token at worst */
+      m_positions = std::make_unique_for_overwrite<uint32_t[]>(data.size() + 1);
+      uint32_t* out { m_positions.get() };
+
+      uint64_t escape_carry { 0 };
+      uint64_t string_carry { 0 };
+      uint64_t scalar_carry { 0 };
+
+      const auto index = [&](const char* block, const size_t offset) {
+        classify::Block b { classifier(block) };
+
+        const uint64_t quote { b.quote & ~bits::escaped(b.backslash, escape_carry) };
+        /* covers the opening quote and the string, not the closing quote */
+        const uint64_t in_string { bits::prefix_xor(quote) ^ string_carry };
+        string_carry = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+        const uint64_t op { b.op & ~in_string };
+        const uint64_t scalar { ~(op | b.space | quote | in_string) };
+        const uint64_t scalar_starts { scalar & ~((scalar << 1) | scalar_carry) };
+        scalar_carry = scalar >> 63;
+
+        if (const uint64_t newline = b.newline & in_string;
+          newline != 0 && m_string_newline == std::string_view::npos) {
+            m_string_newline = offset + std::countr_zero(newline);
+          }
+
+        uint64_t structurals { op | quote | scalar_starts };
+        while (structurals != 0) {
+          *out++ = static_cast<uint32_t>(offset + std::countr_zero(structurals));
+          structurals &= structurals - 1;
+        }
+      };
+
+      size_t offset { 0 };
+      for (; offset + classify::BlockSize <= data.size(); offset += classify::BlockSize) {
+        index(data.data() + offset, offset);
+      }
+
+      if (offset < data.size()) {
+        /* whitespace padding never starts a token */
+        char last[classify::BlockSize];
+        std::memset(last, ' ', sizeof(last));
+        std::memcpy(last, data.data() + offset, data.size() - offset);
+        index(last, offset);
+      }
+
+      m_size = out - m_positions.get();
+      m_unterminated = string_carry != 0;
+    }
+
+    bool StructuralIndex::unterminated() const {
+      return m_unterminated;
+    }
+
+    size_t StructuralIndex::string_newline() const {
+      return m_string_newline;
+    }
+  } // json
+} // lime
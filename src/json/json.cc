@@ -1,58 +1,36 @@
 #include <lime/lime.h>
 #include <lime/json/parser.h>
-#include <format>
+#include <lime/json/writer.h>
 
 namespace lime {
   namespace json {
-    namespace data {
-      [[nodiscard]]
-      static std::string to_string(const json::Data& data) {
-        switch (static_cast<json::NodeType>(data.index())) {
-          case json::NodeType::Int:
-          return std::to_string(std::get<int64_t>(data));
-
-          case json::NodeType::Float:
-          return std::to_string(std::get<double>(data));
-
-          case json::NodeType::Bool:
-          return std::get<bool>(data) ? "true" : "false";
-
-          case json::NodeType::String:
-          return std::format("\"{}\"", std::get<std::string>(data));
-
-          case json::NodeType::Array: {
-            std::string res { "[" }; size_t i { 0 };
-            const auto& arr { std::get<json::Array>(data) };
-            for (const auto& x: arr) {
-              res += data::to_string(x.get());
-              if (i < arr.size() - 1) {
-                res += ", ";
-              }
-            }
-            res += "]";
-            return res;
-          }
-
-          case json::NodeType::Object: {
-            std::string res { "{" }; size_t i { 0 };
-            const auto& obj { std::get<json::Object>(data) };
-            for (const auto& [k, v]: obj) {
-              res += std::format("\"{}\": {}", k, data::to_string(v.get()));
-              if (i < obj.size() - 1) {
-                res += ", ";
-              }
-              i++;
-            }
-            res += "}";
-            return res;
-          }
-
-          default:
-          return {};
-        }
+    std::string to_string(const NodeType& type) {
+      switch (type) {
+        case NodeType::Int:    return "int";
+        case NodeType::Float:  return "float";
+        case NodeType::Bool:   return "bool";
+        case NodeType::String: return "string";
+        case NodeType::Array:  return "array";
+        case NodeType::Object: return "object";
+        default:               return {};
       }
     }
 
+    namespace abi {
+#if JSON_ORDERED_OBJECT
+      int ordered_object() {
+        return 1;
+      }
+#else
+      int unordered_object() {
+        return 0;
+      }
+#endif
+    } // abi
+
+    Node::Node()
+    : m_data(Object {}), m_type(NodeType::Object) {}
+
     Node::Node(const int& data)
     : m_data(data), m_type(NodeType::Int) {}
 
@@ -90,17 +68,38 @@ namespace lime {
     }
 
     std::string Node::to_string() const {
-      return data::to_string(m_data);
+      std::string res {};
+      encode(*this, res);
+      return res;
     }
 
     std::string encode(const Node& node) {
       return node.to_string();
     }
 
+    void encode(const Node& node, std::string& out) {
+      Writer { out }.value(node);
+    }
+
     std::expected<Node, std::string> decode(const std::string& data) {
       Scanner scanner { data };
       Parser  parser { scanner };
-      return parser.parse();
+      auto node { parser.parse() };
+      if (!node) {
+        return node;
+      }
+
+      /* like json::Document, nothing but whitespace may follow the value */
+      const auto token { scanner.token() };
+      if (!token) {
+        return std::unexpected(token.error());
+      }
+
+      if (*token != Token::EndOfFile) {
+        return fmterror("expected end of file", scanner.location());
+      }
+
+      return node;
     }
   } // json
 } // http
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <stdexcept>
+#include <lime/json/json.h>
+
+namespace lime {
+  namespace json {
+    namespace slots {
+      static constexpr uint32_t Empty { 0 };
+
+      [[nodiscard]]
+      static size_t hash(std::string_view key) {
+        return std::hash<std::string_view> {}(key);
+      }
+
+      /* keeps the table at most half full */
+      [[nodiscard]]
+      static size_t capacity(size_t members) {
+        return std::bit_ceil(members * 2);
+      }
+    } // slots
+
+    OrderedObject::OrderedObject() = default;
+
+    OrderedObject::OrderedObject(std::initializer_list<value_type> members) {
+      reserve(members.size());
+      for (const auto& member: members) {
+        insert(member);
+      }
+    }
+
+    OrderedObject::iterator OrderedObject::begin() {
+      return m_members.begin();
+    }
+
+    OrderedObject::iterator OrderedObject::end() {
+      return m_members.end();
+    }
+
+    OrderedObject::const_iterator OrderedObject::begin() const {
+      return m_members.begin();
+    }
+
+    OrderedObject::const_iterator OrderedObject::end() const {
+      return m_members.end();
+    }
+
+    size_t OrderedObject::size() const {
+      return m_members.size();
+    }
+
+    bool OrderedObject::empty() const {
+      return m_members.empty();
+    }
+
+    void OrderedObject::clear() {
+      m_members.clear();
+      m_slots.clear();
+    }
+
+    void OrderedObject::reserve(size_t size) {
+      if (size > m_members.capacity()) {
+        reallocate(size, m_members.end());
+      }
+    }
+
+    /*
+    * keys are const, so std::vector would copy whole members when it grows,
+    * values are moved here instead and only the keys are copied
+    */
+    void OrderedObject::reallocate(size_t capacity, const_iterator skip) {
+      std::vector<value_type> members {};
+      members.reserve(capacity);
+      for (auto it = m_members.begin(); it != m_members.end(); it++) {
+        if (it != skip) {
+          members.emplace_back(it->first, std::move(it->second));
+        }
+      }
+      m_members = std::move(members);
+    }
+
+    size_t OrderedObject::position(std::string_view key) const {
+      if (m_slots.empty()) {
+        for (size_t i = 0; i < m_members.size(); i++) {
+          if (m_members[i].first == key) {
+            return i;
+          }
+        }
+        return m_members.size();
+      }
+
+      const size_t mask { m_slots.size() - 1 };
+      for (size_t slot = slots::hash(key) & mask; m_slots[slot] != slots::Empty; slot = (slot + 1) & mask) {
+        const size_t pos { m_slots[slot] - 1UL };
+        if (m_members[pos].first == key) {
+          return pos;
+        }
+      }
+      return m_members.size();
+    }
+
+    /* records the member at pos, building the table once the object outgrows linear search */
+    void OrderedObject::index(size_t pos) {
+      if (m_members.size() <= JSON_OBJECT_LINEAR_SIZE) {
+        return;
+      }
+
+      if (m_slots.size() < slots::capacity(m_members.size())) {
+        reindex();
+        return;
+      }
+
+      const size_t mask { m_slots.size() - 1 };
+      size_t slot { slots::hash(m_members[pos].first) & mask };
+      while (m_slots[slot] != slots::Empty) {
+        slot = (slot + 1) & mask;
+      }
+      m_slots[slot] = static_cast<uint32_t>(pos + 1);
+    }
+
+    void OrderedObject::reindex() {
+      m_slots.clear();
+      if (m_members.size() <= JSON_OBJECT_LINEAR_SIZE) {
+        return;
+      }
+
+      m_slots.resize(slots::capacity(m_members.size()), slots::Empty);
+      const size_t mask { m_slots.size() - 1 };
+      for (size_t pos = 0; pos < m_members.size(); pos++) {
+        size_t slot { slots::hash(m_members[pos].first) & mask };
+        while (m_slots[slot] != slots::Empty) {
+          slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = static_cast<uint32_t>(pos + 1);
+      }
+    }
+
+    OrderedObject::iterator OrderedObject::find(std::string_view key) {
+      return m_members.begin() + static_cast<ptrdiff_t>(position(key));
+    }
+
+    OrderedObject::const_iterator OrderedObject::find(std::string_view key) const {
+      return m_members.begin() + static_cast<ptrdiff_t>(position(key));
+    }
+
+    bool OrderedObject::contains(std::string_view key) const {
+      return position(key) < m_members.size();
+    }
+
+    size_t OrderedObject::count(std::string_view key) const {
+      return contains(key) ? 1 : 0;
+    }
+
+    Node& OrderedObject::at(std::string_view key) {
+      const size_t pos { position(key) };
+      if (pos >= m_members.size()) {
+        throw std::out_of_range("json object has no such key");
+      }
+      return m_members[pos].second;
+    }
+
+    const Node& OrderedObject::at(std::string_view key) const {
+      const size_t pos { position(key) };
+      if (pos >= m_members.size()) {
+        throw std::out_of_range("json object has no such key");
+      }
+      return m_members[pos].second;
+    }
+
+    std::pair<OrderedObject::iterator, bool> OrderedObject::append(std::string&& key, Node&& value) {
+      if (const size_t pos = position(key); pos < m_members.size()) {
+        return { m_members.begin() + static_cast<ptrdiff_t>(pos), false };
+      }
+
+      if (m_members.size() == m_members.capacity()) {
+        reallocate(std::max<size_t>(4, m_members.capacity() * 2), m_members.end());
+      }
+
+      m_members.emplace_back(std::move(key), std::move(value));
+      index(m_members.size() - 1);
+      return { m_members.end() - 1, true };
+    }
+
+    std::pair<OrderedObject::iterator, bool> OrderedObject::insert(const value_type& member) {
+      return append(std::string { member.first }, Node { member.second });
+    }
+
+    std::pair<OrderedObject::iterator, bool> OrderedObject::insert(value_type&& member) {
+      return append(std::string { member.first }, std::move(member.second));
+    }
+
+    std::pair<OrderedObject::iterator, bool> OrderedObject::insert_or_assign(std::string key, Node value) {
+      if (const size_t pos = position(key); pos < m_members.size()) {
+        m_members[pos].second = std::move(value);
+        return { m_members.begin() + static_cast<ptrdiff_t>(pos), false };
+      }
+
+      return append(std::move(key), std::move(value));
+    }
+
+    Node& OrderedObject::operator[](std::string_view key) {
+      if (const size_t pos = position(key); pos < m_members.size()) {
+        return m_members[pos].second;
+      }
+      return append(std::string { key }, Node {}).first->second;
+    }
+
+    size_t OrderedObject::erase(std::string_view key) {
+      const size_t pos { position(key) };
+      if (pos >= m_members.size()) {
+        return 0;
+      }
+
+      erase(m_members.begin() + static_cast<ptrdiff_t>(pos));
+      return 1;
+    }
+
+    OrderedObject::iterator OrderedObject::erase(const_iterator pos) {
+      const auto offset { pos - m_members.cbegin() };
+      reallocate(m_members.capacity(), pos);
+      /* members after pos moved down, their positions are stale */
+      reindex();
+      return m_members.begin() + offset;
+    }
+  } // json
+} // lime
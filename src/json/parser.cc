@@ -1,11 +1,61 @@
+#include <algorithm>
+#include <charconv>
 #include <expected>
+#include <limits>
+#include <lime/json/escape.h>
 #include <lime/json/parser.h>
+#include <lime/json/reader.h>
 #include <format>
 
 namespace lime {
   namespace json {
-    static std::unexpected<std::string>
-    fmterror(const std::string&, const json::ScannerLocation&);
+    namespace grammar {
+      static bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+      }
+
+      /*
+      * Decimal exponent of the first significant digit plus one,
+      * positive when the magnitude of a valid number is at least 1.
+      */
+      static int64_t magnitude(std::string_view number) {
+        constexpr int64_t limit { 1'000'000'000 };
+        size_t i { number.starts_with('-') ? 1UL : 0UL };
+        int64_t res { 0 };
+        bool significant { false };
+
+        for (; i < number.length() && is_digit(number[i]); i++) {
+          significant = significant || number[i] != '0';
+          res += significant;
+        }
+
+        if (i < number.length() && number[i] == '.') {
+          for (i++; i < number.length() && is_digit(number[i]) && !significant; i++) {
+            significant = number[i] != '0';
+            res -= !significant;
+          }
+
+          while (i < number.length() && is_digit(number[i])) {
+            i++;
+          }
+        }
+
+        if (i < number.length()) {
+          const bool negative { number[++i] == '-' };
+          if (number[i] == '+' || number[i] == '-') {
+            i++;
+          }
+
+          int64_t exponent { 0 };
+          for (; i < number.length(); i++) {
+            exponent = std::min(exponent * 10 + (number[i] - '0'), limit);
+          }
+          res += negative ? -exponent : exponent;
+        }
+
+        return res;
+      }
+    } // grammar
 
     std::string to_string(const Token& t) {
       switch (t) {
@@ -25,160 +75,253 @@ namespace lime {
       }
     }
 
-    Scanner::Scanner(const std::string& data)
-    : m_data(data) {}
+    Scanner::Scanner(std::string_view data, const Isa& isa)
+    : m_data(data), m_index(data, isa) {}
+
+    /* literals run until whitespace, a structural character or a quote */
+    bool Scanner::is_delimiter(size_t pos) const {
+      if (pos >= m_data.length()) {
+        return true;
+      }
 
-    bool Scanner::is_end() const {
-      return m_loc.cursor >= m_data.length();
+      switch (m_data[pos]) {
+        case ' ': case '\t': case '\n': case '\r':
+        case '{': case '}': case '[': case ']':
+        case ':': case ',': case '"':
+        return true;
+
+        default:
+        return false;
+      }
     }
 
-    void Scanner::forward() {
-      if (!is_end() && m_loc.cursor++ &&
-        !is_end() && curr_char() == '\n') {
-          m_loc.row++;
-          m_loc.lnbeg = m_loc.cursor + 1;
-        }
+    ScannerLocation Scanner::location() const {
+      const std::string_view before { m_data.data(), m_cursor };
+      const size_t newline { before.rfind('\n') };
+
+      return ScannerLocation {
+        .cursor = m_cursor,
+        .row = static_cast<size_t>(std::count(before.begin(), before.end(), '\n')),
+        .lnbeg = newline == std::string_view::npos ? 0 : newline + 1,
+      };
     }
 
-    bool Scanner::skip_whitespaces() {
-      while (!is_end() && std::isspace(curr_char())) {
-        forward();
-      }
-      return is_end();
+    size_t Scanner::consumed() const {
+      return m_consumed;
     }
 
-    char Scanner::curr_char() const {
-      if (is_end()) {
-        return 0;
-      }
-      return m_data[m_loc.cursor];
+    size_t Scanner::cursor() const {
+      return m_cursor;
+    }
+
+    char Scanner::peek() const {
+      return m_next < m_index.size() ? m_data[m_index[m_next]] : '\0';
     }
 
-    char Scanner::peek_char() const {
-      if (m_loc.cursor + 1 >= m_data.length()) {
-        return 0;
+    bool Scanner::skip() {
+      size_t depth { 1 };
+      while (m_next < m_index.size()) {
+        m_cursor = m_index[m_next++];
+        switch (m_data[m_cursor]) {
+          case '{': case '[':
+          depth++;
+          break;
+
+          case '}': case ']':
+          if (--depth == 0) {
+            m_consumed = m_cursor + 1;
+            return true;
+          }
+          break;
+
+          /* the closing quote is the next position, strings are not looked into */
+          case '"':
+          m_next++;
+          break;
+
+          default:
+          break;
+        }
       }
-      return m_data[m_loc.cursor + 1];
+
+      return false;
+    }
+
+    bool Scanner::escaped() const {
+      return m_escaped;
     }
 
-    const ScannerLocation& Scanner::location() const {
-      return m_lastloc;
+    bool Scanner::partial() const {
+      return m_partial;
+    }
+
+    size_t Scanner::remaining() const {
+      return m_index.size() - m_next;
     }
 
     std::expected<Token, std::string> Scanner::token() {
-      if (is_end()) {
-        return Token::EndOfFile;
+      if (m_data.length() > std::numeric_limits<uint32_t>::max()) {
+        return fmterror("document too large", location());
       }
 
-      if (skip_whitespaces()) {
+      if (m_next >= m_index.size()) {
         return Token::EndOfFile;
       }
 
-      m_lastloc = m_loc;
+      m_cursor = m_index[m_next++];
+      m_partial = false;
 
       Token t { Token::None };
-      switch (curr_char()) {
-        case '{':
-        t = Token::LeftBrace;
-        break;
-        case '}':
-        t = Token::RightBrace;
-        break;
-        case '[':
-        t = Token::LeftBracket;
-        break;
-        case ']':
-        t = Token::RightBracket;
-        break;
-        case ':':
-        t = Token::Colon;
-        break;
-        case ',':
-        t = Token::Comma;
-        break;
-      }
-
-      if (t != Token::None) {
-        forward();
-        return t;
-      }
-
-      if (std::isdigit(curr_char()) ||
-        (curr_char() == '-' && std::isdigit(peek_char()))) {
-          bool is_float { false };
-          if (curr_char() == '-') {
-            forward();
-          }
+      switch (m_data[m_cursor]) {
+        case '{': t = Token::LeftBrace;    break;
+        case '}': t = Token::RightBrace;   break;
+        case '[': t = Token::LeftBracket;  break;
+        case ']': t = Token::RightBracket; break;
+        case ':': t = Token::Colon;        break;
+        case ',': t = Token::Comma;        break;
+        case '"': return string();
+        default:  return literal();
+      }
 
-          while (!is_end() &&
-            (std::isdigit(curr_char()) || curr_char() == '.')) {
-              if (!is_float && curr_char() == '.') {
-                is_float = true;
-              }
-              forward();
-            }
-
-          const auto& number = m_data.substr(
-            m_lastloc.cursor,
-            m_loc.cursor - m_lastloc.cursor
-          );
-          if (is_float) {
-            m_value = std::stod(number);
-            return Token::Float;
-          }
+      m_consumed = m_cursor + 1;
+      return t;
+    }
 
-          m_value = std::stoll(number);
-          return Token::Int;
+    std::expected<Token, std::string> Scanner::string() {
+      /* the closing quote is always the next indexed position */
+      if (m_next >= m_index.size()) {
+        m_partial = true;
+        return fmterror("unexpected end of string", location());
+      }
+
+      const size_t end { m_index[m_next++] };
+      m_consumed = end + 1;
+      if (const size_t newline = m_index.string_newline();
+        newline > m_cursor && newline < end) {
+          return fmterror("unexpected end of string", location());
         }
 
-      if (std::isalpha(curr_char())) {
-        while (!is_end() && std::isalpha(curr_char())) {
-          forward();
+      const std::string_view contents { m_data.substr(m_cursor + 1, end - m_cursor - 1) };
+      const auto checked { validate(contents) };
+      if (!checked) {
+        m_cursor += 1 + checked.error().offset;
+        return fmterror(std::string(checked.error().reason), location());
+      }
+
+      m_escaped = *checked;
+      m_value = contents;
+      return Token::String;
+    }
+
+    std::expected<Token, std::string> Scanner::literal() {
+      if (m_data[m_cursor] == '-' || grammar::is_digit(m_data[m_cursor])) {
+        return number();
+      }
+
+      size_t end { m_cursor };
+      while (!is_delimiter(end)) {
+        end++;
+      }
+
+      if (m_partial = end >= m_data.length(); !m_partial) {
+        m_consumed = end;
+      }
+
+      const std::string_view ident { m_data.data() + m_cursor, end - m_cursor };
+      if (ident != "true" && ident != "false") {
+        return Token::Invalid;
+      }
+
+      m_value = ident == "true";
+      return Token::Bool;
+    }
+
+    /* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+    std::expected<Token, std::string> Scanner::number() {
+      const auto digits = [this](size_t pos) {
+        while (pos < m_data.length() && grammar::is_digit(m_data[pos])) {
+          pos++;
         }
+        return pos;
+      };
 
-        auto const& ident = m_data.substr(
-          m_lastloc.cursor,
-          m_loc.cursor - m_lastloc.cursor
-        );
-        if (ident != "true" && ident != "false") {
-          return Token::Invalid;
+      size_t end { m_cursor };
+      if (m_data[end] == '-') {
+        end++;
+      }
+
+      const size_t integer { end };
+      end = digits(end);
+      /* no leading zeros */
+      bool valid { end > integer && (m_data[integer] != '0' || end == integer + 1) };
+      bool is_float { false };
+
+      if (valid && end < m_data.length() && m_data[end] == '.') {
+        is_float = true;
+        const size_t fraction { ++end };
+        end = digits(end);
+        valid = end > fraction;
+      }
+
+      if (valid && end < m_data.length() && (m_data[end] == 'e' || m_data[end] == 'E')) {
+        is_float = true;
+        if (++end < m_data.length() && (m_data[end] == '+' || m_data[end] == '-')) {
+          end++;
         }
 
-        m_value = ident == "true";
-        return Token::Bool;
+        const size_t exponent { end };
+        end = digits(end);
+        valid = end > exponent;
       }
 
-      // TODO: handling escape characters like \n \t in string
-      if (curr_char() == '"') {
-        forward();
-        while (!is_end() && curr_char() != '"') {
-          if (curr_char() == '\n') {
-            return fmterror("unexpected end of string", location());
-          }
-          forward();
+      if (m_partial = end >= m_data.length(); !m_partial) {
+        m_consumed = end;
+      }
+
+      if (!valid || !is_delimiter(end)) {
+        return fmterror("invalid number", location());
+      }
+
+      const char* first { m_data.data() + m_cursor };
+      const char* last { m_data.data() + end };
+
+      if (!is_float) {
+        int64_t value {};
+        if (std::from_chars(first, last, value).ec == std::errc {}) {
+          m_value = value;
+          return Token::Int;
+        }
+        /* integers beyond int64_t are kept as doubles */
+      }
+
+      double value {};
+      if (const auto res = std::from_chars(first, last, value); res.ec != std::errc {}) {
+        if (res.ec != std::errc::result_out_of_range || grammar::magnitude({ first, last }) > 0) {
+          return fmterror("number out of range", location());
         }
 
-        auto const& str = m_data.substr(
-          m_lastloc.cursor + 1,
-          m_loc.cursor - m_lastloc.cursor - 1
-        );
-        m_value = str;
-        forward();
-        return Token::String;
+        /* too small for a double */
+        value = *first == '-' ? -0.0 : 0.0;
       }
 
-      return Token::Invalid;
+      m_value = value;
+      return Token::Float;
     }
 
     Parser::Parser(Scanner& sc)
     : m_sc(sc) {}
 
+    std::string Parser::string() const {
+      const std::string_view str { m_sc.get<std::string_view>() };
+      return m_sc.escaped() ? unescape(str) : std::string { str };
+    }
+
     std::expected<Node, std::string> Parser::literal() {
       switch (m_token) {
         case Token::Int:    return m_sc.get<int64_t>();
         case Token::Float:  return m_sc.get<double>();
         case Token::Bool:   return m_sc.get<bool>();
-        case Token::String: return m_sc.get<std::string>();
+        case Token::String: return string();
         default:            return fmterror("expected a literal", m_sc.location());
       }
     }
@@ -197,11 +340,11 @@ namespace lime {
       }
 
       while (true) {
-        const auto& node { parse(false) };
+        auto node { parse(false) };
         if (!node) {
           return node;
         }
-        array.emplace_back(*node);
+        array.emplace_back(std::move(*node));
 
         if (!(token = m_sc.token())) {
           return std::unexpected(token.error());
@@ -242,7 +385,7 @@ namespace lime {
           return fmterror("expected 'string' literal", m_sc.location());
         }
 
-        const std::string key = m_sc.get<std::string>();
+        std::string key { string() };
         if (!(token = m_sc.token())) {
           return std::unexpected(token.error());
         }
@@ -252,12 +395,13 @@ namespace lime {
           return fmterror("expected ':'", m_sc.location());
         }
 
-        const auto& node { parse() };
+        auto node { parse() };
         if (!node) {
           return node;
         }
 
-        object.insert({ key, *node });
+        /* the first of repeated keys wins, every reader of the library agrees on it */
+        object.emplace(std::move(key), std::move(*node));
 
         if (!(token = m_sc.token())) {
           return std::unexpected(token.error());
@@ -290,17 +434,19 @@ namespace lime {
         m_token = *token;
       }
 
-
-      switch (m_token) {
-        case Token::LeftBrace:
-        return object();
-
-        case Token::LeftBracket:
-        return array();
-
-        default:
+      if (m_token != Token::LeftBrace && m_token != Token::LeftBracket) {
         return literal();
       }
+
+      /* the recursion is bounded like the stack of json::Reader */
+      if (m_depth >= JSON_READER_MAX_DEPTH) {
+        return fmterror("nesting too deep", m_sc.location());
+      }
+
+      m_depth++;
+      auto node { m_token == Token::LeftBrace ? object() : array() };
+      m_depth--;
+      return node;
     }
 
     std::unexpected<std::string>
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <lime/json/escape.h>
+#include <lime/json/parser.h>
+#include <lime/json/pointer.h>
+
+namespace lime {
+  namespace json {
+    namespace pointer {
+      using Path = std::vector<std::string>;
+
+      /* reference tokens of a pointer with ~1 and ~0 decoded, std::nullopt if malformed */
+      [[nodiscard]]
+      static std::optional<Path> split(std::string_view pointer) {
+        Path res {};
+        if (pointer.empty()) {
+          return res;
+        }
+
+        if (pointer.front() != '/') {
+          return std::nullopt;
+        }
+
+        pointer.remove_prefix(1);
+        while (true) {
+          const size_t end { std::min(pointer.find('/'), pointer.length()) };
+          std::string token {};
+          token.reserve(end);
+
+          for (size_t i = 0; i < end; i++) {
+            if (pointer[i] != '~') {
+              token += pointer[i];
+              continue;
+            }
+
+            if (i + 1 >= end || (pointer[i + 1] != '0' && pointer[i + 1] != '1')) {
+              return std::nullopt;
+            }
+            token += pointer[++i] == '0' ? '~' : '/';
+          }
+
+          res.emplace_back(std::move(token));
+          if (end == pointer.length()) {
+            return res;
+          }
+          pointer.remove_prefix(end + 1);
+        }
+      }
+
+      /* array index of a reference token, without leading zeros */
+      [[nodiscard]]
+      static std::optional<size_t> index(std::string_view token) {
+        if (token.empty() || (token.length() > 1 && token.front() == '0')) {
+          return std::nullopt;
+        }
+
+        size_t res { 0 };
+        const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.length(), res);
+        if (ec != std::errc {} || ptr != token.data() + token.length()) {
+          return std::nullopt;
+        }
+        return res;
+      }
+
+      [[nodiscard]]
+      static const Node* walk(const Node& node, std::span<const std::string> path) {
+        const Node* current { &node };
+        for (const auto& token: path) {
+          if (current->type() == NodeType::Object) {
+            const auto& object { current->get<Object>() };
+            const auto it { object.find(token) };
+            if (it == object.end()) {
+              return nullptr;
+            }
+            current = &it->second;
+          } else if (current->type() == NodeType::Array) {
+            const auto& array { current->get<Array>() };
+            const auto i { index(token) };
+            if (!i || *i >= array.size()) {
+              return nullptr;
+            }
+            current = &array[*i];
+          } else {
+            return nullptr;
+          }
+        }
+        return current;
+      }
+
+      /*
+      * Walks a document with the pointers still unresolved below the current
+      * value, parsing the values they end at and skipping everything else.
+      */
+      class Extractor {
+      public:
+        Extractor(std::string_view data, std::vector<Path> paths)
+        : m_sc(data), m_paths(std::move(paths)), m_results(m_paths.size()),
+          m_done(m_paths.size(), false), m_left(m_paths.size()) {}
+
+        std::expected<std::vector<std::optional<Node>>, std::string> run() {
+          std::vector<size_t> wanted(m_paths.size());
+          for (size_t i = 0; i < wanted.size(); i++) {
+            wanted[i] = i;
+          }
+
+          if (const auto res = value(0, wanted); !res) {
+            return std::unexpected(res.error());
+          }
+
+          /* the rest of the document is only checked when it was read anyway */
+          if (m_left == 0 && !m_stopped) {
+            const auto token { m_sc.token() };
+            if (!token) {
+              return std::unexpected(token.error());
+            }
+
+            if (*token != Token::EndOfFile) {
+              return fmterror("expected end of file", m_sc.location());
+            }
+          }
+
+          return std::move(m_results);
+        }
+
+      private:
+        void resolve(size_t i, std::optional<Node> node) {
+          m_results[i] = std::move(node);
+          m_done[i] = true;
+          m_left--;
+        }
+
+        /* pointers of wanted continuing with token at depth */
+        [[nodiscard]]
+        std::vector<size_t> below(const std::vector<size_t>& wanted, size_t depth, const auto& matches) const {
+          std::vector<size_t> res {};
+          for (const size_t i: wanted) {
+            if (!m_done[i] && matches(m_paths[i][depth])) {
+              res.push_back(i);
+            }
+          }
+          return res;
+        }
+
+        std::expected<void, std::string> value(size_t depth, const std::vector<size_t>& wanted) {
+          const bool whole {
+            std::any_of(wanted.begin(), wanted.end(), [this, depth](size_t i) {
+              return m_paths[i].size() == depth;
+            })
+          };
+
+          /* pointers ending here take the value, longer ones are answered from it */
+          if (whole) {
+            Parser parser { m_sc };
+            const auto node { parser.parse() };
+            if (!node) {
+              return std::unexpected(node.error());
+            }
+
+            for (const size_t i: wanted) {
+              const Node* found { walk(*node, std::span { m_paths[i] }.subspan(depth)) };
+              resolve(i, found ? std::optional<Node> { *found } : std::nullopt);
+            }
+            return {};
+          }
+
+          const auto token { m_sc.token() };
+          if (!token) {
+            return std::unexpected(token.error());
+          }
+
+          std::expected<void, std::string> res {};
+          switch (*token) {
+            case Token::LeftBrace:
+            res = wanted.empty() ? skip() : object(depth, wanted);
+            break;
+
+            case Token::LeftBracket:
+            res = wanted.empty() ? skip() : array(depth, wanted);
+            break;
+
+            case Token::Int: case Token::Float: case Token::Bool: case Token::String:
+            break;
+
+            default:
+            return fmterror("expected a literal", m_sc.location());
+          }
+
+          if (!res || m_left == 0) {
+            return res;
+          }
+
+          /* whatever was not found below this value is missing */
+          for (const size_t i: wanted) {
+            if (!m_done[i]) {
+              resolve(i, std::nullopt);
+            }
+          }
+          return {};
+        }
+
+        std::expected<void, std::string> skip() {
+          if (!m_sc.skip()) {
+            return fmterror("unexpected end of file", m_sc.location());
+          }
+          return {};
+        }
+
+        std::expected<void, std::string> object(size_t depth, const std::vector<size_t>& wanted) {
+          auto token { m_sc.token() };
+          if (token && *token == Token::RightBrace) {
+            return {};
+          }
+
+          while (true) {
+            if (!token) {
+              return std::unexpected(token.error());
+            }
+
+            if (*token != Token::String) {
+              return fmterror("expected 'string' literal", m_sc.location());
+            }
+
+            const std::string_view raw { m_sc.get<std::string_view>() };
+            std::string unescaped {};
+            const std::string_view key { m_sc.escaped() ? std::string_view { unescaped = unescape(raw) } : raw };
+
+            if (!(token = m_sc.token())) {
+              return std::unexpected(token.error());
+            }
+
+            if (*token != Token::Colon) {
+              return fmterror("expected ':'", m_sc.location());
+            }
+
+            const auto next {
+              below(wanted, depth, [key](const std::string& token) {
+                return token == key;
+              })
+            };
+
+            if (const auto res = value(depth + 1, next); !res) {
+              return res;
+            }
+
+            if (m_left == 0) {
+              m_stopped = true;
+              return {};
+            }
+
+            if (!(token = m_sc.token())) {
+              return std::unexpected(token.error());
+            }
+
+            if (*token == Token::RightBrace) {
+              return {};
+            }
+
+            if (*token != Token::Comma) {
+              return fmterror("expected ',' or '}'", m_sc.location());
+            }
+            token = m_sc.token();
+          }
+        }
+
+        std::expected<void, std::string> array(size_t depth, const std::vector<size_t>& wanted) {
+          /* elements are read by value(), so an empty array is only peeked at */
+          if (m_sc.peek() == ']') {
+            if (const auto token = m_sc.token(); !token) {
+              return std::unexpected(token.error());
+            }
+            return {};
+          }
+
+          for (size_t i = 0; ; i++) {
+            const auto next {
+              below(wanted, depth, [i](const std::string& token) {
+                return index(token) == i;
+              })
+            };
+
+            if (const auto res = value(depth + 1, next); !res) {
+              return res;
+            }
+
+            if (m_left == 0) {
+              m_stopped = true;
+              return {};
+            }
+
+            const auto token { m_sc.token() };
+            if (!token) {
+              return std::unexpected(token.error());
+            }
+
+            if (*token == Token::RightBracket) {
+              return {};
+            }
+
+            if (*token != Token::Comma) {
+              return fmterror("expected ',' or ']'", m_sc.location());
+            }
+          }
+        }
+
+        Scanner                          m_sc;
+        std::vector<Path>                m_paths;
+        std::vector<std::optional<Node>> m_results;
+        std::vector<bool>                m_done;
+        size_t                           m_left = 0;
+        bool                             m_stopped = false;
+      };
+    } // pointer
+
+    std::expected<std::vector<std::optional<Node>>, std::string>
+    extract(std::string_view data, std::span<const std::string_view> pointers) {
+      std::vector<pointer::Path> paths {};
+      paths.reserve(pointers.size());
+
+      for (const auto& p: pointers) {
+        auto path { pointer::split(p) };
+        if (!path) {
+          return std::unexpected(std::format("invalid json pointer '{}'", p));
+        }
+        paths.emplace_back(std::move(*path));
+      }
+
+      if (paths.empty()) {
+        return std::vector<std::optional<Node>> {};
+      }
+
+      return pointer::Extractor { data, std::move(paths) }.run();
+    }
+
+    const Node* Node::at_pointer(std::string_view p) const {
+      const auto path { pointer::split(p) };
+      return path ? pointer::walk(*this, *path) : nullptr;
+    }
+
+    Node* Node::at_pointer(std::string_view p) {
+      return const_cast<Node*>(std::as_const(*this).at_pointer(p));
+    }
+  } // json
+} // lime
@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <lime/json/escape.h>
+#include <lime/json/parser.h>
+#include <lime/json/reader.h>
+
+namespace lime {
+  namespace json {
+    std::string to_string(const Event& event) {
+      switch (event) {
+        case Event::NeedMore:    return "need more";
+        case Event::StartObject: return "start object";
+        case Event::EndObject:   return "end object";
+        case Event::StartArray:  return "start array";
+        case Event::EndArray:    return "end array";
+        case Event::Key:         return "key";
+        case Event::Value:       return "value";
+        case Event::End:         return "end";
+        case Event::Error:       return "error";
+        default:                 return {};
+      }
+    }
+
+    Reader::Reader() = default;
+
+    Reader::Reader(std::string_view document)
+    : m_document(document), m_finished(true), m_in_place(true) {}
+    Reader::~Reader() = default;
+    Reader::Reader(Reader&&) noexcept = default;
+    Reader& Reader::operator=(Reader&&) noexcept = default;
+
+    /* forgets the bytes of every token already read */
+    void Reader::drop() {
+      const size_t consumed { m_scanner ? m_scanner->consumed() : 0 };
+      m_scanner.reset();
+      if (consumed == 0) {
+        return;
+      }
+
+      const std::string_view dropped { m_buffer.data(), consumed };
+      if (const size_t newline = dropped.rfind('\n'); newline != std::string_view::npos) {
+        m_row += std::count(dropped.begin(), dropped.end(), '\n');
+        m_column = consumed - newline - 1;
+      } else {
+        m_column += consumed;
+      }
+
+      m_buffer.erase(0, consumed);
+      if (m_search != std::string::npos) {
+        m_search -= consumed;
+      }
+    }
+
+    /*
+    * looks for the end of the split token in the input not searched yet,
+    * so a long token fed in many chunks is read once instead of once per chunk
+    */
+    bool Reader::token_end() {
+      const std::string_view data { m_buffer };
+      if (!m_search_string) {
+        const size_t end { data.find_first_of(" \t\n\r{}[]:,\"", m_search) };
+        m_search = end == std::string_view::npos ? data.size() : std::string::npos;
+        return end != std::string_view::npos;
+      }
+
+      while (m_search < data.size()) {
+        if (m_search_escape) {
+          m_search_escape = false;
+          m_search++;
+          continue;
+        }
+
+        m_search += find_escape(data.substr(m_search));
+        if (m_search >= data.size()) {
+          break;
+        }
+
+        if (data[m_search] == '"') {
+          m_search = std::string::npos;
+          return true;
+        }
+
+        m_search_escape = data[m_search] == '\\';
+        m_search++;
+      }
+      return false;
+    }
+
+    void Reader::feed(std::string_view chunk) {
+      drop();
+      m_buffer.append(chunk);
+      m_need_more = m_search != std::string::npos && !token_end();
+    }
+
+    void Reader::finish() {
+      drop();
+      m_search = std::string::npos;
+      m_finished = true;
+      m_need_more = false;
+    }
+
+    Event Reader::fail(const std::string& msg) {
+      ScannerLocation loc { m_scanner->location() };
+      if (loc.row == 0) {
+        loc.cursor += m_column;
+      }
+      loc.row += m_row;
+
+      m_error = fmterror(msg, loc).error();
+      m_expect = Expect::Done;
+      m_stack.clear();
+      return Event::Error;
+    }
+
+    std::string_view Reader::unescaped(std::string_view str, bool escaped, std::string& storage) {
+      if (!escaped) {
+        return str;
+      }
+
+      storage = unescape(str);
+      return storage;
+    }
+
+    Event Reader::close(const NodeType& type) {
+      m_stack.pop_back();
+      m_expect = m_stack.empty() ? Expect::Done : Expect::CommaOrEnd;
+      return type == NodeType::Object ? Event::EndObject : Event::EndArray;
+    }
+
+    Event Reader::step() {
+      if (!m_error.empty()) {
+        return Event::Error;
+      }
+
+      while (true) {
+        if (m_need_more) {
+          return Event::NeedMore;
+        }
+
+        if (!m_scanner) {
+          m_scanner = std::make_unique<Scanner>(m_in_place ? m_document : std::string_view { m_buffer });
+        }
+
+        const auto token { m_scanner->token() };
+        if (m_scanner->partial() && !m_finished) {
+          const size_t start { m_scanner->cursor() };
+          m_search_string = m_buffer[start] == '"';
+          m_search_escape = false;
+          m_search = start + (m_search_string ? 1 : 0);
+          /* moves the search to the end of the input, the next chunk scans the token again if it ended anyway */
+          [[maybe_unused]] const bool ended { token_end() };
+
+          m_need_more = true;
+          continue;
+        }
+
+        if (!token) {
+          /* located again relative to the whole document */
+          const std::string& error { token.error() };
+          return fail(error.substr(error.find(' ') + 1));
+        }
+
+        if (*token == Token::EndOfFile) {
+          if (!m_finished) {
+            m_need_more = true;
+            continue;
+          }
+
+          if (m_expect != Expect::Done) {
+            return fail("unexpected end of file");
+          }
+          return Event::End;
+        }
+
+        switch (m_expect) {
+          case Expect::ValueOrEnd:
+          if (*token == Token::RightBracket) {
+            return close(NodeType::Array);
+          }
+          [[fallthrough]];
+
+          case Expect::Value:
+          switch (*token) {
+            case Token::LeftBrace:
+            case Token::LeftBracket: {
+              if (m_stack.size() >= JSON_READER_MAX_DEPTH) {
+                return fail("maximum depth exceeded");
+              }
+
+              const bool object { *token == Token::LeftBrace };
+              m_stack.push_back(object ? NodeType::Object : NodeType::Array);
+              m_expect = object ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+              return object ? Event::StartObject : Event::StartArray;
+            }
+
+            case Token::Int:
+            m_value = m_scanner->get<int64_t>();
+            break;
+
+            case Token::Float:
+            m_value = m_scanner->get<double>();
+            break;
+
+            case Token::Bool:
+            m_value = m_scanner->get<bool>();
+            break;
+
+            case Token::String:
+            m_value = unescaped(m_scanner->get<std::string_view>(), m_scanner->escaped(), m_unescaped_value);
+            break;
+
+            default:
+            return fail("expected a literal");
+          }
+
+          m_expect = m_stack.empty() ? Expect::Done : Expect::CommaOrEnd;
+          return Event::Value;
+
+          case Expect::KeyOrEnd:
+          if (*token == Token::RightBrace) {
+            return close(NodeType::Object);
+          }
+          [[fallthrough]];
+
+          case Expect::Key:
+          if (*token != Token::String) {
+            return fail("expected 'string' literal");
+          }
+
+          m_key = unescaped(m_scanner->get<std::string_view>(), m_scanner->escaped(), m_unescaped_key);
+          m_expect = Expect::Colon;
+          return Event::Key;
+
+          case Expect::Colon:
+          if (*token != Token::Colon) {
+            return fail("expected ':'");
+          }
+
+          m_expect = Expect::Value;
+          continue;
+
+          case Expect::CommaOrEnd: {
+            const bool object { m_stack.back() == NodeType::Object };
+            if (*token == (object ? Token::RightBrace : Token::RightBracket)) {
+              return close(m_stack.back());
+            }
+
+            if (*token != Token::Comma) {
+              return fail(object ? "expected ',' or '}'" : "expected ',' or ']'");
+            }
+
+            m_expect = object ? Expect::Key : Expect::Value;
+            continue;
+          }
+
+          case Expect::Done:
+          return fail("expected end of file");
+        }
+      }
+    }
+
+    Event Reader::next() {
+      while (true) {
+        const Event event { step() };
+        if (!m_skipping) {
+          return event;
+        }
+
+        switch (event) {
+          case Event::EndObject:
+          case Event::EndArray:
+          if (m_stack.size() == m_skip) {
+            m_skipping = false;
+            return event;
+          }
+          break;
+
+          case Event::NeedMore:
+          case Event::End:
+          case Event::Error:
+          return event;
+
+          default:
+          break;
+        }
+      }
+    }
+
+    void Reader::skip() {
+      if (m_stack.empty()) {
+        return;
+      }
+
+      m_skip = m_stack.size() - 1;
+      m_skipping = true;
+    }
+
+    std::string_view Reader::key() const {
+      return m_key;
+    }
+
+    NodeType Reader::type() const {
+      return static_cast<NodeType>(m_value.index());
+    }
+
+    size_t Reader::depth() const {
+      return m_stack.size();
+    }
+
+    const std::string& Reader::error() const {
+      return m_error;
+    }
+  } // json
+} // lime
@@ -0,0 +1,204 @@
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <lime/json/escape.h>
+#include <lime/json/writer.h>
+
+namespace lime {
+  namespace json {
+    Writer::Writer(std::string& out)
+    : m_out(out) {}
+
+    Writer::Writer(std::string& out, Sink sink, size_t threshold)
+    : m_out(out), m_sink(std::move(sink)), m_threshold(threshold) {}
+
+    /* nothing written yet, inside an array or after the key of a member */
+    bool Writer::expects_value() const {
+      return !m_complete && (m_stack.empty() || !m_stack.back() || m_after_key);
+    }
+
+    /* comma before anything but the first element of a container or a member value */
+    void Writer::separate() {
+      if (m_after_key) {
+        m_after_key = false;
+        return;
+      }
+
+      if (!m_first) {
+        m_out += ", ";
+      }
+      m_first = false;
+    }
+
+    void Writer::written() {
+      if (m_stack.empty()) {
+        m_complete = true;
+      }
+
+      if (m_sink && m_out.size() >= m_threshold) {
+        flush();
+      }
+    }
+
+    Writer& Writer::begin_object() {
+      assert(expects_value());
+      separate();
+      m_out += '{';
+      m_stack.push_back(true);
+      m_first = true;
+      return *this;
+    }
+
+    Writer& Writer::end_object() {
+      assert(!m_stack.empty() && m_stack.back() && !m_after_key);
+      m_out += '}';
+      m_stack.pop_back();
+      m_first = false;
+      written();
+      return *this;
+    }
+
+    Writer& Writer::begin_array() {
+      assert(expects_value());
+      separate();
+      m_out += '[';
+      m_stack.push_back(false);
+      m_first = true;
+      return *this;
+    }
+
+    Writer& Writer::end_array() {
+      assert(!m_stack.empty() && !m_stack.back());
+      m_out += ']';
+      m_stack.pop_back();
+      m_first = false;
+      written();
+      return *this;
+    }
+
+    Writer& Writer::key(std::string_view key) {
+      assert(!m_stack.empty() && m_stack.back() && !m_after_key);
+      separate();
+      escape(key, m_out);
+      m_out += ": ";
+      m_after_key = true;
+      return *this;
+    }
+
+    Writer& Writer::integer(int64_t value) {
+      assert(expects_value());
+      separate();
+
+      char buffer[24];
+      const auto [end, _] { std::to_chars(buffer, buffer + sizeof(buffer), value) };
+      m_out.append(buffer, end);
+      written();
+      return *this;
+    }
+
+    Writer& Writer::integer(uint64_t value) {
+      assert(expects_value());
+      separate();
+
+      char buffer[24];
+      const auto [end, _] { std::to_chars(buffer, buffer + sizeof(buffer), value) };
+      m_out.append(buffer, end);
+      written();
+      return *this;
+    }
+
+    /* shortest representation that parses back to the same double */
+    Writer& Writer::value(double value) {
+      assert(expects_value());
+      separate();
+
+      if (!std::isfinite(value)) {
+        m_out += "null";
+        written();
+        return *this;
+      }
+
+      char buffer[32];
+      const auto [end, _] { std::to_chars(buffer, buffer + sizeof(buffer), value) };
+      m_out.append(buffer, end);
+
+      /* keep integral values floats when decoded again */
+      if (std::string_view { buffer, end }.find_first_of(".e") == std::string_view::npos) {
+        m_out += ".0";
+      }
+
+      written();
+      return *this;
+    }
+
+    Writer& Writer::value(bool value) {
+      assert(expects_value());
+      separate();
+      m_out += value ? "true" : "false";
+      written();
+      return *this;
+    }
+
+    Writer& Writer::value(std::string_view value) {
+      assert(expects_value());
+      separate();
+      escape(value, m_out);
+      written();
+      return *this;
+    }
+
+    Writer& Writer::value(const char* value) {
+      return this->value(std::string_view { value });
+    }
+
+    Writer& Writer::value(const std::string& value) {
+      return this->value(std::string_view { value });
+    }
+
+    Writer& Writer::value(const Node& node) {
+      switch (node.type()) {
+        case NodeType::Int:
+        return integer(node.get<int64_t>());
+
+        case NodeType::Float:
+        return value(node.get<double>());
+
+        case NodeType::Bool:
+        return value(node.get<bool>());
+
+        case NodeType::String:
+        return value(std::string_view { node.get<std::string>() });
+
+        case NodeType::Array:
+        begin_array();
+        for (const auto& element: node.get<Array>()) {
+          value(element);
+        }
+        return end_array();
+
+        case NodeType::Object:
+        begin_object();
+        for (const auto& [k, v]: node.get<Object>()) {
+          key(k).value(v);
+        }
+        return end_object();
+
+        default:
+        return *this;
+      }
+    }
+
+    void Writer::flush() {
+      if (!m_sink || m_out.empty()) {
+        return;
+      }
+
+      m_sink(m_out);
+      m_out.clear();
+    }
+
+    bool Writer::complete() const {
+      return m_complete;
+    }
+  } // json
+} // lime
@@ -0,0 +1,113 @@
+#include <stdexcept>
+#include <lime/metrics/metrics.h>
+
+namespace lime {
+  namespace metrics {
+    namespace shard {
+      size_t assign() {
+        static std::atomic<size_t> s_next { 0 };
+        return s_next.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARDS;
+      }
+    } // shard
+
+    uint64_t Counter::value() const {
+      uint64_t res { 0 };
+      for (const auto& shard: m_shards) {
+        res += shard.value.load(std::memory_order_relaxed);
+      }
+      return res;
+    }
+
+    Histogram::Snapshot Histogram::snapshot() const {
+      Snapshot res {};
+      for (const auto& shard: m_shards) {
+        for (size_t i = 0; i < Buckets; i++) {
+          const uint64_t count { shard.counts[i].load(std::memory_order_relaxed) };
+          res.counts[i] += count;
+          res.count += count;
+        }
+        res.sum += shard.sum.load(std::memory_order_relaxed);
+      }
+      return res;
+    }
+
+    uint64_t Histogram::Snapshot::quantile(double q) const {
+      if (count == 0) {
+        return 0;
+      }
+
+      const uint64_t rank { std::max<uint64_t>(1, static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count) + 0.5)) };
+      uint64_t seen { 0 };
+      for (size_t i = 0; i < Buckets; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+          return upper(i);
+        }
+      }
+      return upper(Buckets - 1);
+    }
+
+    Metric& Registry::get(const std::string& name, const std::string& help, const Labels& labels, Type type) {
+      for (auto& metric: m_metrics) {
+        if (metric.name != name) {
+          continue;
+        }
+
+        if (metric.type != type) {
+          throw std::invalid_argument("metric '" + name + "' is registered with another type");
+        }
+
+        if (metric.labels == labels) {
+          return metric;
+        }
+      }
+
+      Metric& metric { m_metrics.emplace_back() };
+      metric.name = name;
+      metric.help = help;
+      metric.labels = labels;
+      metric.type = type;
+      return metric;
+    }
+
+    Counter& Registry::counter(const std::string& name, const std::string& help, const Labels& labels) {
+      std::lock_guard lock { m_mutex };
+      Metric& metric { get(name, help, labels, Type::Counter) };
+      if (!metric.counter) {
+        metric.counter = std::make_unique<Counter>();
+      }
+      return *metric.counter;
+    }
+
+    Gauge& Registry::gauge(const std::string& name, const std::string& help, const Labels& labels) {
+      std::lock_guard lock { m_mutex };
+      Metric& metric { get(name, help, labels, Type::Gauge) };
+      if (!metric.gauge) {
+        metric.gauge = std::make_unique<Gauge>();
+      }
+      return *metric.gauge;
+    }
+
+    Histogram& Registry::histogram(const std::string& name, const std::string& help, const Labels& labels, double scale) {
+      std::lock_guard lock { m_mutex };
+      Metric& metric { get(name, help, labels, Type::Histogram) };
+      if (!metric.histogram) {
+        metric.histogram = std::make_unique<Histogram>();
+        metric.scale = scale;
+      }
+      return *metric.histogram;
+    }
+
+    void Registry::visit(const std::function<void(const Metric&)>& func) const {
+      std::lock_guard lock { m_mutex };
+      for (const auto& metric: m_metrics) {
+        func(metric);
+      }
+    }
+
+    Registry& registry() {
+      static Registry registry {};
+      return registry;
+    }
+  } // metrics
+} // lime
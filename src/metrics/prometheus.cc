@@ -0,0 +1,164 @@
+#include <charconv>
+#include <string_view>
+#include <unordered_map>
+#include <lime/metrics/prometheus.h>
+
+namespace lime {
+  namespace metrics {
+    namespace text {
+      template <typename T>
+      static void number(std::string& out, T value) {
+        char buffer[32];
+        const auto [end, _] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, end);
+      }
+
+      /* label values and help texts escape backslashes and newlines, label values quotes too */
+      static void escaped(std::string& out, std::string_view str, bool quotes) {
+        for (const char c: str) {
+          switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '"':  out += quotes ? "\\\"" : "\""; break;
+            default:   out += c; break;
+          }
+        }
+      }
+
+      static void labels(std::string& out, const Labels& labels, std::string_view le = {}) {
+        if (labels.empty() && le.empty()) {
+          return;
+        }
+
+        out += '{';
+        bool first { true };
+        for (const auto& [name, value]: labels) {
+          if (!first) {
+            out += ',';
+          }
+          first = false;
+
+          out += name;
+          out += "=\"";
+          escaped(out, value, true);
+          out += '"';
+        }
+
+        if (!le.empty()) {
+          out += first ? "le=\"" : ",le=\"";
+          out += le;
+          out += '"';
+        }
+        out += '}';
+      }
+
+      [[nodiscard]]
+      static std::string_view type(const Type& type) {
+        switch (type) {
+          case Type::Counter: return "counter";
+          case Type::Gauge:   return "gauge";
+          default:            return "histogram";
+        }
+      }
+
+      static void histogram(std::string& out, const Metric& metric) {
+        const auto snapshot { metric.histogram->snapshot() };
+        const size_t step { size_t { 1 } << Histogram::SubBits };
+
+        /* the last bucket of every power of two ends at the next one */
+        uint64_t cumulative { 0 };
+        for (size_t i = 0; i < Histogram::Buckets; i++) {
+          cumulative += snapshot.counts[i];
+          if (i % step != step - 1 || i == Histogram::Buckets - 1) {
+            continue;
+          }
+
+          char le[32];
+          const auto [end, _] = std::to_chars(le, le + sizeof(le), static_cast<double>(Histogram::upper(i)) * metric.scale);
+
+          out += metric.name;
+          out += "_bucket";
+          labels(out, metric.labels, { le, end });
+          out += ' ';
+          number(out, cumulative);
+          out += '\n';
+        }
+
+        out += metric.name;
+        out += "_bucket";
+        labels(out, metric.labels, "+Inf");
+        out += ' ';
+        number(out, snapshot.count);
+        out += '\n';
+
+        out += metric.name;
+        out += "_sum";
+        labels(out, metric.labels);
+        out += ' ';
+        if (metric.scale == 1.0) {
+          number(out, snapshot.sum);
+        } else {
+          number(out, static_cast<double>(snapshot.sum) * metric.scale);
+        }
+        out += '\n';
+
+        out += metric.name;
+        out += "_count";
+        labels(out, metric.labels);
+        out += ' ';
+        number(out, snapshot.count);
+        out += '\n';
+      }
+    } // text
+
+    void prometheus(const Registry& registry, std::string& out) {
+      /* metrics of a name are grouped under one HELP and TYPE, in the order the names were first registered */
+      std::vector<std::vector<const Metric*>> groups {};
+      std::unordered_map<std::string_view, size_t> index {};
+
+      registry.visit([&](const Metric& metric) {
+        const auto [it, inserted] = index.try_emplace(metric.name, groups.size());
+        if (inserted) {
+          groups.emplace_back();
+        }
+        groups[it->second].push_back(&metric);
+      });
+
+      for (const auto& group: groups) {
+        const Metric& first { *group.front() };
+        out += "# HELP ";
+        out += first.name;
+        out += ' ';
+        text::escaped(out, first.help, false);
+        out += "\n# TYPE ";
+        out += first.name;
+        out += ' ';
+        out += text::type(first.type);
+        out += '\n';
+
+        for (const Metric* metric: group) {
+          if (metric->type == Type::Histogram) {
+            text::histogram(out, *metric);
+            continue;
+          }
+
+          out += metric->name;
+          text::labels(out, metric->labels);
+          out += ' ';
+          if (metric->type == Type::Counter) {
+            text::number(out, metric->counter->value());
+          } else {
+            text::number(out, metric->gauge->value());
+          }
+          out += '\n';
+        }
+      }
+    }
+
+    std::string prometheus(const Registry& registry) {
+      std::string res {};
+      prometheus(registry, res);
+      return res;
+    }
+  } // metrics
+} // lime
@@ -1,10 +1,15 @@
 #include <lime/lime.h>
+#include <signal.h>
+#include <pthread.h>
 #include <mutex>
 #include <format>
 
 namespace lime {
-  DynamicThreadPool::DynamicThreadPool(size_t max_workers) {
-    debug(std::format("setting up {} workers", max_workers));
+  DynamicThreadPool::DynamicThreadPool(size_t max_workers, bool record)
+  : m_queue_wait(metrics::registry().histogram("lime_pool_queue_wait_seconds", "Time tasks waited for a worker", {}, 1e-9)),
+    m_queued(metrics::registry().gauge("lime_pool_queued_tasks", "Tasks waiting for a worker")),
+    m_record(record) {
+    debug("setting up {} workers", max_workers);
     for (size_t i = 0; i < max_workers; i++) {
       m_workers.emplace_back([i, this](std::stop_token stoken) {
         this->worker(i, stoken);
@@ -21,9 +26,13 @@ namespace lime {
     {
       std::lock_guard lock { m_tasks_mutex };
       m_tasks.emplace(
-        std::forward<std::function<void()>>(func)
+        std::forward<std::function<void()>>(func),
+        std::chrono::steady_clock::now()
       );
     }
+    if (m_record) {
+      m_queued.add();
+    }
     m_task_available.notify_one();
   }
 
@@ -35,13 +44,20 @@ namespace lime {
   }
 
   void DynamicThreadPool::worker(const size_t id, std::stop_token stoken) {
+    /* shutdown signals are left to the thread running the server */
+    sigset_t set {};
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
     while (!stoken.stop_requested()) {
-      std::function<void()> task {};
+      Job task {};
 
       {
         std::unique_lock lock { m_tasks_mutex };
 
-        debug(std::format("thread: {}: waiting for task", id));
+        debug("thread: {}: waiting for task", id);
         m_task_available.wait(lock, [this, &stoken]() {
           return m_stop || !m_tasks.empty() || stoken.stop_requested();
         });
@@ -49,13 +65,18 @@ namespace lime {
         if (m_stop && m_tasks.empty())
           return;
 
-        debug(std::format("thread: {}: dequeuing task from queue", id));
+        debug("thread: {}: dequeuing task from queue", id);
         task = std::move(m_tasks.front());
         m_tasks.pop();
       }
 
-      debug(std::format("thread: {}: running task", id));
-      task();
+      if (m_record) {
+        m_queued.sub();
+        m_queue_wait.record(std::chrono::steady_clock::now() - task.queued);
+      }
+
+      debug("thread: {}: running task", id);
+      task.func();
     }
   }
 } // lime
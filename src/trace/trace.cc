@@ -0,0 +1,230 @@
+#include <charconv>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <lime/json/escape.h>
+#include <lime/trace/trace.h>
+
+#if TRACE_USE_TSC
+  #include <cpuid.h>
+#endif
+
+namespace lime {
+  namespace trace {
+    namespace calibration {
+      /* a reading of both clocks taken when the library is loaded */
+      struct Reference {
+        Ticks                                 ticks;
+        std::chrono::steady_clock::time_point time;
+      };
+
+      static const Reference s_reference { now(), std::chrono::steady_clock::now() };
+
+      /*
+      * nanoseconds per tick measured against the steady clock since the
+      * reference, waiting until at least a millisecond passed
+      */
+      [[nodiscard]]
+      static double measure() {
+        if (!tsc()) {
+          return 1.0;
+        }
+
+        while (std::chrono::steady_clock::now() - s_reference.time < std::chrono::milliseconds { 1 }) {
+          std::this_thread::yield();
+        }
+
+        const Ticks ticks { now() };
+        const auto time { std::chrono::steady_clock::now() };
+        return std::chrono::duration<double, std::nano> { time - s_reference.time }.count()
+          / static_cast<double>(ticks - s_reference.ticks);
+      }
+
+      [[nodiscard]]
+      static double ns_per_tick() {
+        static const double res { measure() };
+        return res;
+      }
+
+      /* microseconds since the reference, the unit of trace event timestamps */
+      [[nodiscard]]
+      static double micros(Ticks ticks) {
+        return static_cast<double>(elapsed(s_reference.ticks, ticks).count()) / 1000.0;
+      }
+    } // calibration
+
+    bool invariant_tsc() {
+    #if TRACE_USE_TSC
+      unsigned int eax {}, ebx {}, ecx {}, edx {};
+      if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+      }
+      return (edx & (1u << 8)) != 0;
+    #else
+      return false;
+    #endif
+    }
+
+    std::chrono::nanoseconds elapsed(Ticks from, Ticks to) {
+      const double ticks { static_cast<double>(static_cast<int64_t>(to - from)) };
+      return std::chrono::nanoseconds { static_cast<int64_t>(ticks * calibration::ns_per_tick()) };
+    }
+
+    const char* to_string(const Phase& phase) {
+      switch (phase) {
+        case Phase::Accepted:        return "accepted";
+        case Phase::Started:         return "started";
+        case Phase::HeadRead:        return "head read";
+        case Phase::BodyRead:        return "body read";
+        case Phase::Routed:          return "routed";
+        case Phase::HandlerStarted:  return "handler started";
+        case Phase::HandlerFinished: return "handler finished";
+        case Phase::Serialized:      return "serialized";
+        case Phase::Written:         return "written";
+        default:                     return "";
+      }
+    }
+
+    std::chrono::nanoseconds Timings::between(const Phase& from, const Phase& to) const {
+      if (!reached(from) || !reached(to)) {
+        return std::chrono::nanoseconds { 0 };
+      }
+      return elapsed(at(from), at(to));
+    }
+
+    std::chrono::nanoseconds Timings::since(const Phase& from) const {
+      if (!reached(from)) {
+        return std::chrono::nanoseconds { 0 };
+      }
+      return elapsed(at(from), now());
+    }
+
+    namespace buffer {
+      static std::atomic<bool> s_enabled { false };
+      static std::mutex        s_mutex;
+      /* guarded by s_mutex, s_next is where the next span goes once the buffer is full */
+      static std::vector<Span> s_spans;
+      static size_t            s_capacity = 0;
+      static size_t            s_next = 0;
+    } // buffer
+
+    void enable(size_t capacity) {
+      std::lock_guard lock { buffer::s_mutex };
+      buffer::s_spans.clear();
+      buffer::s_spans.reserve(capacity);
+      buffer::s_capacity = capacity;
+      buffer::s_next = 0;
+      buffer::s_enabled = capacity > 0;
+    }
+
+    void disable() {
+      std::lock_guard lock { buffer::s_mutex };
+      buffer::s_enabled = false;
+    }
+
+    bool enabled() {
+      return buffer::s_enabled.load(std::memory_order_relaxed);
+    }
+
+    void record(Span span) {
+      if (!enabled()) {
+        return;
+      }
+
+      std::lock_guard lock { buffer::s_mutex };
+      if (buffer::s_capacity == 0) {
+        return;
+      }
+
+      if (buffer::s_spans.size() < buffer::s_capacity) {
+        buffer::s_spans.push_back(std::move(span));
+        return;
+      }
+
+      buffer::s_spans[buffer::s_next] = std::move(span);
+      buffer::s_next = (buffer::s_next + 1) % buffer::s_capacity;
+    }
+
+    namespace event {
+      template <typename T>
+      static void number(std::string& out, T value) {
+        char buffer[32];
+        const auto [end, _] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, end);
+      }
+
+      /* what happens until a phase is reached */
+      [[nodiscard]]
+      static std::string_view interval(const Phase& to) {
+        switch (to) {
+          case Phase::Started:         return "wait for request";
+          case Phase::HeadRead:        return "read head";
+          case Phase::BodyRead:        return "read body";
+          case Phase::Routed:          return "route";
+          case Phase::HandlerStarted:  return "queue";
+          case Phase::HandlerFinished: return "handler";
+          case Phase::Serialized:      return "serialize";
+          case Phase::Written:         return "write";
+          default:                     return "";
+        }
+      }
+
+      /* a complete event, from one tick to another on the track of a connection */
+      static void complete(std::string& out, std::string_view name, Ticks from, Ticks to, int track) {
+        out += out.back() == '[' ? "\n" : ",\n";
+        out += "{\"name\":";
+        json::escape(name, out);
+        out += ",\"cat\":\"lime\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+        number(out, track);
+        out += ",\"ts\":";
+        number(out, calibration::micros(from));
+        out += ",\"dur\":";
+        number(out, static_cast<double>(elapsed(from, to).count()) / 1000.0);
+      }
+    } // event
+
+    void chrome(std::string& out) {
+      std::vector<Span> spans {};
+      {
+        std::lock_guard lock { buffer::s_mutex };
+        spans.reserve(buffer::s_spans.size());
+        spans.insert(spans.end(), buffer::s_spans.begin() + buffer::s_next, buffer::s_spans.end());
+        spans.insert(spans.end(), buffer::s_spans.begin(), buffer::s_spans.begin() + buffer::s_next);
+      }
+
+      out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+      for (const auto& span: spans) {
+        const Timings& t { span.timings };
+        const Phase first { t.reached(Phase::Accepted) ? Phase::Accepted : Phase::Started };
+        if (!t.reached(first) || !t.reached(Phase::Written)) {
+          continue;
+        }
+
+        event::complete(out, span.name, t.at(first), t.at(Phase::Written), span.track);
+        out += ",\"args\":{\"status\":";
+        event::number(out, span.status);
+        out += "}}";
+
+        /* each phase lasts until the next one reached */
+        Phase from { first };
+        for (size_t i = static_cast<size_t>(first) + 1; i < Phases; i++) {
+          const Phase to { static_cast<Phase>(i) };
+          if (!t.reached(to)) {
+            continue;
+          }
+
+          event::complete(out, event::interval(to), t.at(from), t.at(to), span.track);
+          out += '}';
+          from = to;
+        }
+      }
+      out += "\n]}\n";
+    }
+
+    std::string chrome() {
+      std::string res {};
+      chrome(res);
+      return res;
+    }
+  } // trace
+} // lime
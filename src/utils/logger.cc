@@ -1,32 +1,424 @@
 #include <lime/lime.h>
-#include <print>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifndef LOGGER_BUFFER_SIZE
+  /* bytes of messages a thread can queue, a power of two */
+  #define LOGGER_BUFFER_SIZE (256 * 1024)
+#endif
+
+#ifndef LOGGER_FLUSH_INTERVAL
+  /* milliseconds the background thread sleeps between writes when idle */
+  #define LOGGER_FLUSH_INTERVAL 10
+#endif
+
+#ifndef LOGGER_BATCH_SIZE
+  /* messages handed to a single writev */
+  #define LOGGER_BATCH_SIZE 256
+#endif
 
 namespace lime {
-  static LogLevel s_level { LogLevel::Info };
+  namespace logging {
+    std::atomic<LogLevel> level { LogLevel::Info };
+
+    static_assert((LOGGER_BUFFER_SIZE & (LOGGER_BUFFER_SIZE - 1)) == 0, "LOGGER_BUFFER_SIZE must be a power of two");
+
+    /* set once the logger is destroyed, later messages are written directly */
+    static std::atomic<bool> s_gone { false };
+
+    enum class Stream : uint32_t {
+      Out,
+      Err,
+      /* access log records, written as they are without a newline */
+      Access,
+    };
+
+    inline constexpr size_t Streams { 3 };
+
+    [[nodiscard]]
+    static std::string_view newline(const Stream& stream) {
+      return stream == Stream::Access ? "" : "\n";
+    }
+
+    /*
+    * Single producer, single consumer ring of records: a 4 byte header with
+    * the length and stream of the message followed by the message, padded to
+    * 4 bytes so headers never wrap around.
+    */
+    class Ring {
+    public:
+      Ring()
+      : m_data(std::make_unique<char[]>(LOGGER_BUFFER_SIZE)) {}
+
+      /* called by the owning thread only */
+      bool push(const Stream& stream, std::string_view prefix, std::string_view msg) {
+        const size_t length { prefix.length() + msg.length() + newline(stream).length() };
+        const size_t size { record(length) };
+        const uint64_t head { m_head.load(std::memory_order_relaxed) };
+        if (head + size - m_tail.load(std::memory_order_acquire) > LOGGER_BUFFER_SIZE) {
+          return false;
+        }
+
+        const uint32_t header { static_cast<uint32_t>(length << 2) | static_cast<uint32_t>(stream) };
+        std::memcpy(m_data.get() + (head & Mask), &header, sizeof(header));
+
+        uint64_t pos { head + sizeof(header) };
+        copy(pos, prefix);
+        copy(pos, msg);
+        copy(pos, newline(stream));
+
+        m_head.store(head + size, std::memory_order_release);
+        return true;
+      }
+
+      [[nodiscard]]
+      bool fits(size_t length) const {
+        return record(length) <= LOGGER_BUFFER_SIZE / 2;
+      }
+
+      [[nodiscard]]
+      bool half_full() const {
+        return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed) > LOGGER_BUFFER_SIZE / 2;
+      }
+
+      /*
+      * Point iovecs of each stream at the queued messages without copying
+      * them. Returns the position the tail can be released to once the
+      * iovecs are written.
+      */
+      uint64_t collect(std::vector<iovec> (&streams)[Streams], size_t limit) const {
+        const uint64_t head { m_head.load(std::memory_order_acquire) };
+        uint64_t tail { m_tail.load(std::memory_order_relaxed) };
+
+        size_t count { 0 };
+        while (tail != head && count + 2 <= limit) {
+          uint32_t header {};
+          std::memcpy(&header, m_data.get() + (tail & Mask), sizeof(header));
+
+          const size_t length { header >> 2 };
+          auto& iov { streams[header & 3] };
+          const size_t begin { (tail + sizeof(header)) & Mask };
+          const size_t first { std::min(length, LOGGER_BUFFER_SIZE - begin) };
+
+          iov.push_back({ m_data.get() + begin, first });
+          if (first < length) {
+            iov.push_back({ m_data.get(), length - first });
+            count++;
+          }
+          count++;
+          tail += record(length);
+        }
+        return tail;
+      }
+
+      void release(uint64_t tail) {
+        m_tail.store(tail, std::memory_order_release);
+      }
+
+      [[nodiscard]]
+      bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed);
+      }
+
+      /* set when the owning thread exits */
+      std::atomic<bool> orphaned { false };
+
+    private:
+      static constexpr uint64_t Mask { LOGGER_BUFFER_SIZE - 1 };
+
+      [[nodiscard]]
+      static size_t record(size_t length) {
+        return sizeof(uint32_t) + ((length + 3) & ~static_cast<size_t>(3));
+      }
+
+      void copy(uint64_t& pos, std::string_view data) {
+        const size_t begin { pos & Mask };
+        const size_t first { std::min(data.length(), LOGGER_BUFFER_SIZE - begin) };
+        std::memcpy(m_data.get() + begin, data.data(), first);
+        std::memcpy(m_data.get(), data.data() + first, data.length() - first);
+        pos += data.length();
+      }
+
+      std::unique_ptr<char[]> m_data;
+      alignas(64) std::atomic<uint64_t> m_head { 0 };
+      alignas(64) std::atomic<uint64_t> m_tail { 0 };
+    };
+
+    /* writes every iovec, continuing after partial writes */
+    static void write_all(int fd, iovec* iov, size_t count) {
+      while (count > 0) {
+        const ssize_t written { writev(fd, iov, static_cast<int>(std::min<size_t>(count, IOV_MAX))) };
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return;
+        }
+
+        size_t left { static_cast<size_t>(written) };
+        while (count > 0 && left >= iov->iov_len) {
+          left -= iov->iov_len;
+          iov++;
+          count--;
+        }
+
+        if (count > 0) {
+          iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+          iov->iov_len -= left;
+        }
+      }
+    }
+
+    class Logger {
+    public:
+      static Logger& instance() {
+        static Logger logger {};
+        return logger;
+      }
+
+      Logger()
+      : m_thread([this](std::stop_token token) { run(token); }) {}
+
+      ~Logger() {
+        s_gone = true;
+        m_thread.request_stop();
+        m_wake.notify_one();
+        m_thread.join();
+        flush();
+
+        for (auto& file: { std::ref(m_file), std::ref(m_access_file) }) {
+          if (const int fd = file.get().exchange(-1); fd >= 0) {
+            close(fd);
+          }
+        }
+      }
+
+      void log(const Stream& stream, std::string_view prefix, std::string_view msg) {
+        Ring& ring { local() };
+        if (!ring.fits(prefix.length() + msg.length() + 1)) {
+          std::lock_guard lock { m_drain_mutex };
+          drain();
+          direct(target(stream), stream, prefix, msg);
+          return;
+        }
+
+        if (!ring.push(stream, prefix, msg)) {
+          m_dropped.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+
+        if (ring.half_full() && !m_pending.exchange(true)) {
+          m_wake.notify_one();
+        }
+      }
+
+      void flush() {
+        std::lock_guard lock { m_drain_mutex };
+        drain();
+      }
+
+      bool file(const Stream& stream, const std::string& path) {
+        const int fd { open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644) };
+        if (fd < 0) {
+          return false;
+        }
+
+        std::lock_guard lock { m_drain_mutex };
+        drain();
+        auto& file { stream == Stream::Access ? m_access_file : m_file };
+        if (const int old = file.exchange(fd); old >= 0) {
+          close(old);
+        }
+        return true;
+      }
+
+      [[nodiscard]]
+      size_t dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+      }
+
+      /* access records go to their own file if one is set, otherwise with the other messages */
+      [[nodiscard]]
+      int target(const Stream& stream) const {
+        if (stream == Stream::Access) {
+          if (const int file = m_access_file.load(); file >= 0) {
+            return file;
+          }
+        }
+
+        if (const int file = m_file.load(); file >= 0) {
+          return file;
+        }
+        return stream == Stream::Err ? STDERR_FILENO : STDOUT_FILENO;
+      }
+
+      /* written without queueing when the logger is gone or a message does not fit */
+      static void direct(int fd, const Stream& stream, std::string_view prefix, std::string_view msg) {
+        const std::string_view end { newline(stream) };
+        iovec iov[] {
+          { const_cast<char*>(prefix.data()), prefix.length() },
+          { const_cast<char*>(msg.data()), msg.length() },
+          { const_cast<char*>(end.data()), end.length() },
+        };
+        write_all(fd, iov, 3);
+      }
+
+    private:
+      /* keeps the ring of a thread registered until its messages are written */
+      struct Local {
+        std::shared_ptr<Ring> ring;
+
+        ~Local() {
+          if (ring) {
+            ring->orphaned = true;
+          }
+        }
+      };
+
+      Ring& local() {
+        thread_local Local local {};
+        if (!local.ring) {
+          local.ring = std::make_shared<Ring>();
+          std::lock_guard lock { m_rings_mutex };
+          m_rings.push_back(local.ring);
+        }
+        return *local.ring;
+      }
+
+      void run(std::stop_token token) {
+        /*
+        * the thread starts on the first message, which can be before a server
+        * blocks its shutdown signals, so it must never be the one receiving them
+        */
+        sigset_t set {};
+        sigfillset(&set);
+        for (const int signo: { SIGSEGV, SIGBUS, SIGFPE, SIGILL }) {
+          sigdelset(&set, signo);
+        }
+        pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+        std::mutex mutex {};
+        while (!token.stop_requested()) {
+          flush();
+
+          std::unique_lock lock { mutex };
+          m_wake.wait_for(lock, token, std::chrono::milliseconds { LOGGER_FLUSH_INTERVAL }, [this]() {
+            return m_pending.exchange(false);
+          });
+        }
+      }
+
+      /* called with m_drain_mutex held */
+      void drain() {
+        std::vector<std::shared_ptr<Ring>> rings {};
+        {
+          std::lock_guard lock { m_rings_mutex };
+          std::erase_if(m_rings, [](const std::shared_ptr<Ring>& ring) {
+            return ring->orphaned && ring->empty();
+          });
+          rings = m_rings;
+        }
+
+        for (const auto& ring: rings) {
+          while (!ring->empty()) {
+            for (auto& iov: m_streams) {
+              iov.clear();
+            }
+
+            const uint64_t tail { ring->collect(m_streams, LOGGER_BATCH_SIZE) };
+            for (size_t i = 0; i < Streams; i++) {
+              write_all(target(static_cast<Stream>(i)), m_streams[i].data(), m_streams[i].size());
+            }
+            ring->release(tail);
+          }
+        }
+
+        const int file { m_file.load() };
+        if (const size_t dropped = m_dropped.load(std::memory_order_relaxed); dropped != m_reported) {
+          const std::string msg { std::format("dropped {} log messages, the buffers were full", dropped - m_reported) };
+          m_reported = dropped;
+
+          iovec iov[] {
+            { const_cast<char*>("[WARN] "), 7 },
+            { const_cast<char*>(msg.data()), msg.length() },
+            { const_cast<char*>("\n"), 1 },
+          };
+          write_all(file >= 0 ? file : STDERR_FILENO, iov, 3);
+        }
+      }
+
+      std::mutex                         m_rings_mutex;
+      std::vector<std::shared_ptr<Ring>> m_rings;
+
+      std::mutex                  m_drain_mutex;
+      std::vector<iovec>          m_streams[Streams];
+      size_t                      m_reported = 0;
+      std::atomic<size_t>         m_dropped { 0 };
+      std::atomic<int>            m_file { -1 };
+      std::atomic<int>            m_access_file { -1 };
+      /* a ring filled up, the background thread should not wait for the interval */
+      std::atomic<bool>           m_pending { false };
+      std::condition_variable_any m_wake;
+      std::jthread                m_thread;
+    };
+
+    static std::string_view prefix(const LogLevel& level) {
+      switch (level) {
+        case LogLevel::Debug:   return "[DEBUG] ";
+        case LogLevel::Warning: return "[WARN] ";
+        case LogLevel::Info:    return "[INFO] ";
+        default:                return "[ERROR] ";
+      }
+    }
+
+    static void log(const Stream& stream, std::string_view prefix, std::string_view msg) {
+      if (s_gone) {
+        Logger::direct(stream == Stream::Err ? STDERR_FILENO : STDOUT_FILENO, stream, prefix, msg);
+        return;
+      }
+      Logger::instance().log(stream, prefix, msg);
+    }
+
+    void write(const LogLevel& level, std::string_view msg) {
+      log(level == LogLevel::None ? Stream::Err : Stream::Out, prefix(level), msg);
+    }
+  } // logging
 
   void loglevel(const LogLevel& level) {
-    s_level = level;
+    logging::level.store(level, std::memory_order_relaxed);
   }
 
-  void info(const std::string& msg) {
-    if (s_level <= LogLevel::Info) {
-      std::println("[INFO] {}", msg);
-    }
+  bool logfile(const std::string& path) {
+    return !logging::s_gone && logging::Logger::instance().file(logging::Stream::Out, path);
   }
 
-  void warning(const std::string& msg) {
-    if (s_level <= LogLevel::Warning) {
-      std::println("[WARN] {}", msg);
-    }
+  void access_log(std::string_view record) {
+    logging::log(logging::Stream::Access, "", record);
+  }
+
+  bool access_logfile(const std::string& path) {
+    return !logging::s_gone && logging::Logger::instance().file(logging::Stream::Access, path);
   }
 
-  void debug(const std::string& msg) {
-    if (s_level <= LogLevel::Debug) {
-      std::println("[DEBUG] {}", msg);
+  void flush_logs() {
+    if (!logging::s_gone) {
+      logging::Logger::instance().flush();
     }
   }
 
-  void error(const std::string& msg) {
-    std::println(stderr, "[ERROR] {}", msg);
+  size_t dropped_logs() {
+    return logging::s_gone ? 0 : logging::Logger::instance().dropped();
   }
 } // lime
@@ -14,10 +14,24 @@ paths = [
     "test3",
     "test4",
     "test5",
+    "test6",
+    "test7",
+    "test8",
+    "test9",
+    "test10",
+    "test11",
+    "test12",
+    "test13",
+    "test14",
+    "test15",
+    "test16",
+    "test17",
+    "test18",
 ]
 
 isjson = {
     "test5": True,
+    "test7": True,
 }
 
 CXX = os.environ.get("CXX")
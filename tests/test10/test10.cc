@@ -0,0 +1,52 @@
+#include <cstring>
+#include <lime.h>
+
+int main() {
+  namespace http = lime::http;
+  namespace json = lime::json;
+  namespace trace = lime::trace;
+
+  trace::enable();
+
+  http::Router router;
+  /* the phases reached before the handler runs */
+  router.add("/phases", http::Method::Get, [](const http::Request& req) {
+    std::string res {};
+    for (size_t i = 0; i < trace::Phases; i++) {
+      const auto phase { static_cast<trace::Phase>(i) };
+      if (req.timings.reached(phase)) {
+        res += res.empty() ? "" : ", ";
+        res += trace::to_string(phase);
+      }
+    }
+
+    const bool ordered {
+      req.timings.between(trace::Phase::Accepted, trace::Phase::HandlerStarted).count() >= 0
+      && req.timings.since(trace::Phase::Started).count() > 0
+    };
+    return http::Response(ordered ? res : "phases out of order");
+  });
+
+  /* the names of the events of every traced request */
+  router.add("/events", http::Method::Get, [](const http::Request&) {
+    const auto dump { json::decode(trace::chrome()) };
+    if (!dump) {
+      return http::Response(dump.error(), http::StatusCode::InternalServerError);
+    }
+
+    std::string res {};
+    for (const auto& event: dump->at_pointer("/traceEvents")->get<json::Array>()) {
+      res += res.empty() ? "" : ", ";
+      res += event.at_pointer("/name")->get<std::string>();
+    }
+    return http::Response(res);
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <lime.h>
+
+namespace http = lime::http;
+
+/* sends a request on a new connection and returns the body of the response */
+static std::string get(const std::string& path) {
+  const int fd { socket(AF_INET, SOCK_STREAM, 0) };
+  sockaddr_in addr {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(8080);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return "";
+  }
+
+  const std::string req { std::format("GET {} HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n", path) };
+  (void)write(fd, req.data(), req.size());
+
+  std::string res {};
+  char buffer[1024];
+  for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+    res.append(buffer, n);
+  }
+  close(fd);
+
+  const size_t body { res.find("\r\n") };
+  return body == std::string::npos ? "" : res.substr(body + 2);
+}
+
+int main() {
+  std::atomic<int> counts { 0 };
+  std::atomic<int> missing { 0 };
+  std::atomic<int> slow { 0 };
+
+  http::Router router;
+  router.add("/count", http::Method::Get, [&counts](const http::Request&) {
+    return http::Response(std::to_string(++counts));
+  });
+  router.cache("/count", http::Method::Get, { .ttl = std::chrono::seconds { 60 }, .params = std::vector<std::string> { "id" } });
+
+  /* only 2xx responses are kept */
+  router.add("/missing", http::Method::Get, [&missing](const http::Request&) {
+    return http::Response(std::to_string(++missing), http::StatusCode::NotFound);
+  });
+  router.cache("/missing", http::Method::Get, {});
+
+  router.add("/slow", http::Method::Get, [&slow](const http::Request&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 200 });
+    return http::Response(std::to_string(++slow));
+  });
+  router.cache("/slow", http::Method::Get, { .ttl = std::chrono::seconds { 60 } });
+
+  /* requests arriving together run the slow handler once */
+  router.add("/burst", http::Method::Get, [](const http::Request&) {
+    std::vector<std::string> bodies(4);
+    {
+      std::vector<std::jthread> clients {};
+      for (auto& body: bodies) {
+        clients.emplace_back([&body]() {
+          body = get("/slow");
+        });
+      }
+    }
+
+    std::string res {};
+    for (const auto& body: bodies) {
+      res += res.empty() ? body : " " + body;
+    }
+    return http::Response(res);
+  });
+
+  /* the body is not part of the key, so routes with side effects are refused */
+  router.add("/post", http::Method::Post, [](const http::Request&) {
+    return http::Response("post");
+  });
+  std::string refused { "accepted" };
+  try {
+    router.cache("/post", http::Method::Post, {});
+  } catch (const std::invalid_argument& e) {
+    refused = e.what();
+  }
+  router.add("/refused", http::Method::Get, [&refused](const http::Request&) {
+    return http::Response(refused);
+  });
+
+  /* responses for one client are neither kept nor shared */
+  std::atomic<int> cookies { 0 };
+  router.add("/cookie", http::Method::Get, [&cookies](const http::Request&) {
+    http::Response res { std::to_string(++cookies) };
+    res.set_header("Set-Cookie", "session=" + res.body());
+    return res;
+  });
+  router.cache("/cookie", http::Method::Get, { .ttl = std::chrono::seconds { 60 } });
+
+  std::atomic<int> private_slow { 0 };
+  router.add("/private", http::Method::Get, [&private_slow](const http::Request&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 200 });
+    http::Response res { std::to_string(++private_slow) };
+    res.set_header("Cache-Control", "max-age=60, Private");
+    return res;
+  });
+  router.cache("/private", http::Method::Get, { .ttl = std::chrono::seconds { 60 } });
+
+  /* requests arriving together each get their own private response */
+  router.add("/private-burst", http::Method::Get, [](const http::Request&) {
+    std::vector<std::string> bodies(4);
+    {
+      std::vector<std::jthread> clients {};
+      for (auto& body: bodies) {
+        clients.emplace_back([&body]() {
+          body = get("/private");
+        });
+      }
+    }
+
+    std::ranges::sort(bodies);
+    std::string res {};
+    for (const auto& body: bodies) {
+      res += res.empty() ? body : " " + body;
+    }
+    return http::Response(res);
+  });
+
+  http::Server server(router, 4);
+  router.add("/size", http::Method::Get, [&server](const http::Request&) {
+    return http::Response(std::to_string(server.cache().size()));
+  });
+
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
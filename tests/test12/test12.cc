@@ -0,0 +1,45 @@
+#include <atomic>
+#include <cstring>
+#include <lime.h>
+
+int main() {
+  namespace http = lime::http;
+
+  std::atomic<int> built { 0 };
+
+  http::Router router;
+  router.add("/auto", http::Method::Get, [](const http::Request&) {
+    return http::Response("hello");
+  });
+
+  /* the handler knows the version and skips building the body the client holds */
+  router.add("/versioned", http::Method::Get, [&built](const http::Request& req) {
+    if (req.not_modified("v7")) {
+      http::Response res { http::StatusCode::NotModified };
+      res.set_etag("v7");
+      return res;
+    }
+
+    built++;
+    http::Response res { "version 7" };
+    res.set_etag("v7");
+    return res;
+  });
+
+  router.add("/built", http::Method::Get, [&built](const http::Request&) {
+    return http::Response(std::to_string(built));
+  });
+
+  router.add("/cached", http::Method::Get, [](const http::Request&) {
+    return http::Response("cached");
+  });
+  router.cache("/cached", http::Method::Get, { .ttl = std::chrono::seconds { 60 } });
+
+  http::Server server(router);
+  if(server.port(8080).etags(true).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
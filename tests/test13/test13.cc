@@ -0,0 +1,172 @@
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <lime.h>
+
+namespace http = lime::http;
+
+/* opens a connection to a port on the loopback, -1 on failure */
+static int connect_to(const uint16_t port) {
+  const int fd { socket(AF_INET, SOCK_STREAM, 0) };
+  sockaddr_in addr {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* reads until the server closes the connection */
+static std::string read_all(const int fd) {
+  std::string res {};
+  char buffer[1024];
+  for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+    res.append(buffer, n);
+  }
+  return res;
+}
+
+/* the status line and whether the server asked to close, or what went wrong */
+static std::string summary(const std::string& res) {
+  if (res.empty()) {
+    return "no response";
+  }
+  std::string status { res.substr(0, res.find('\n')) };
+  if (status.ends_with('\r')) {
+    status.pop_back();
+  }
+  return std::format("{}, {}", status, res.contains("Connection: close") ? "close" : "keep-alive");
+}
+
+/*
+* stops a server from another thread while a slow request is in progress
+* and another connection has sent nothing yet
+*/
+static std::string stop_during(const std::chrono::milliseconds& deadline) {
+  http::Router router;
+  router.add("/slow", http::Method::Get, [](const http::Request&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 300 });
+    return http::Response("slow");
+  });
+
+  http::Server server(router, 1);
+  if (server.addrs("127.0.0.1").port(0).start() < 0) {
+    return strerror(errno);
+  }
+
+  const int idle { connect_to(server.port()) };
+  const int busy { connect_to(server.port()) };
+  const std::string req { "GET /slow HTTP/1.1\r\nHost: localhost\r\n\r\n" };
+  (void)write(busy, req.data(), req.size());
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+
+  const http::DrainReport report { server.stop(deadline) };
+  const std::string res { read_all(busy) };
+  const bool closed { read_all(idle).empty() };
+  close(busy);
+  close(idle);
+
+  return std::format(
+    "{} | drained {}, aborted {} | idle {}",
+    summary(res), report.drained, report.aborted, closed ? "closed" : "answered"
+  );
+}
+
+/* a server of its own process stopped by SIGTERM, writes its port and then its report to out */
+static int signalled(const int out) {
+  http::Router router;
+  router.add("/slow", http::Method::Get, [](const http::Request&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 300 });
+    return http::Response("slow");
+  });
+
+  http::Server server(router);
+  if (server.port(0).handle_signals(true).start() < 0) {
+    return 1;
+  }
+
+  const uint16_t port { server.port() };
+  (void)write(out, &port, sizeof(port));
+
+  const int ret { server.wait() };
+  const http::DrainReport report { server.stop() };
+  (void)write(out, &report, sizeof(report));
+  return ret < 0 ? 1 : 0;
+}
+
+/* sends SIGTERM to a server with a request in progress, which has to finish it before exiting */
+static std::string terminate() {
+  int fds[2];
+  if (pipe(fds) < 0) {
+    return strerror(errno);
+  }
+
+  const pid_t child { fork() };
+  if (child == 0) {
+    close(fds[0]);
+    std::exit(signalled(fds[1]));
+  }
+  close(fds[1]);
+
+  uint16_t port { 0 };
+  if (read(fds[0], &port, sizeof(port)) != sizeof(port)) {
+    return "server did not start";
+  }
+
+  const int fd { connect_to(port) };
+  const std::string req { "GET /slow HTTP/1.1\r\nHost: localhost\r\n\r\n" };
+  (void)write(fd, req.data(), req.size());
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+
+  kill(child, SIGTERM);
+  const std::string res { read_all(fd) };
+  close(fd);
+
+  int status { 0 };
+  waitpid(child, &status, 0);
+
+  http::DrainReport report {};
+  (void)read(fds[0], &report, sizeof(report));
+  close(fds[0]);
+
+  return std::format(
+    "{} | drained {}, aborted {} | {}",
+    summary(res), report.drained, report.aborted,
+    WIFEXITED(status) ? std::format("exit {}", WEXITSTATUS(status)) : std::format("killed by {}", WTERMSIG(status))
+  );
+}
+
+int main() {
+  /* forks while this process has no threads yet */
+  const std::string terminated { terminate() };
+
+  http::Router router;
+  router.add("/sigterm", http::Method::Get, [&terminated](const http::Request&) {
+    return http::Response(terminated);
+  });
+
+  /* the deadline leaves time for the slow request to finish */
+  router.add("/drain", http::Method::Get, [](const http::Request&) {
+    return http::Response(stop_during(std::chrono::seconds { 2 }));
+  });
+
+  /* the slow request is still running at the deadline */
+  router.add("/abort", http::Method::Get, [](const http::Request&) {
+    return http::Response(stop_during(std::chrono::milliseconds { 50 }));
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <format>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+#include <lime.h>
+
+namespace http = lime::http;
+
+/* sends a request on a new connection and returns the body of the response, empty when none came in time */
+static std::string get(const uint16_t port, const std::string& path, const std::chrono::milliseconds& wait = {}) {
+  const int fd { socket(AF_INET, SOCK_STREAM, 0) };
+  if (wait.count() > 0) {
+    const timeval timeout { .tv_sec = 0, .tv_usec = static_cast<suseconds_t>(wait.count() * 1000) };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  }
+  sockaddr_in addr {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return "refused";
+  }
+
+  const std::string req { std::format("GET {} HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n", path) };
+  (void)write(fd, req.data(), req.size());
+
+  std::string res {};
+  char buffer[1024];
+  for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+    res.append(buffer, n);
+  }
+  close(fd);
+
+  const size_t body { res.find("\r\n") };
+  return body == std::string::npos ? "" : res.substr(body + 2);
+}
+
+/* a router answering with a fixed name */
+static http::Router named(const std::string& name) {
+  http::Router router;
+  router.add("/name", http::Method::Get, [name](const http::Request&) {
+    return http::Response(name);
+  });
+  return router;
+}
+
+/* the system picks the port, which is read back once listening */
+static std::string ephemeral() {
+  const http::Router router { named("ephemeral") };
+  http::Server server(router, 1);
+  if (server.addrs("127.0.0.1").port(0).start() < 0) {
+    return strerror(errno);
+  }
+
+  const uint16_t port { server.port() };
+  const std::string res { std::format("{} | {}", port != 0 ? "port set" : "port 0", get(port, "/name")) };
+  server.stop();
+  return std::format("{} | after stop {}", res, get(port, "/name"));
+}
+
+/* stopped by another thread while this one waits, then started again */
+static std::string restart() {
+  const http::Router router { named("restarted") };
+  http::Server server(router, 1);
+  std::string res {};
+
+  for (int i = 0; i < 2; i++) {
+    if (server.addrs("127.0.0.1").port(0).start() < 0) {
+      return strerror(errno);
+    }
+
+    std::string body {};
+    std::jthread stopper([&server, &body]() {
+      body = get(server.port(), "/name");
+      server.stop();
+    });
+
+    const int ret { server.wait() };
+    stopper.join();
+    res += std::format("{}run {}: {} {}", res.empty() ? "" : " | ", i + 1, body, ret);
+  }
+  return res;
+}
+
+/* two servers of one process on ports of their own */
+static std::string pair() {
+  const http::Router first_router { named("first") };
+  const http::Router second_router { named("second") };
+  http::Server first(first_router, 1);
+  http::Server second(second_router, 1);
+
+  if (first.addrs("127.0.0.1").port(0).start() < 0 || second.addrs("127.0.0.1").port(0).start() < 0) {
+    return strerror(errno);
+  }
+
+  const std::string res {
+    std::format(
+      "{} {} | {}",
+      get(first.port(), "/name"),
+      get(second.port(), "/name"),
+      first.port() != second.port() ? "distinct ports" : "same port"
+    )
+  };
+
+  first.stop();
+  return std::format("{} | second after first stopped: {}", res, get(second.port(), "/name"));
+}
+
+/*
+* stopped while a cached handler fills a key another request waits for, the
+* key must not outlive the run and hold back requests after the restart
+*/
+static std::string refill() {
+  std::atomic<int> calls { 0 };
+  http::Router router;
+  router.add("/slow", http::Method::Get, [&calls](const http::Request&) {
+    if (calls++ == 0) {
+      std::this_thread::sleep_for(std::chrono::seconds { 1 });
+    }
+    return http::Response("filled");
+  });
+  router.cache("/slow", http::Method::Get, { .ttl = std::chrono::seconds { 60 } });
+
+  http::Server server(router, 2);
+  if (server.addrs("127.0.0.1").port(0).start() < 0) {
+    return strerror(errno);
+  }
+
+  {
+    const uint16_t port { server.port() };
+    std::jthread filling([port]() { (void)get(port, "/slow"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+    std::jthread waiting([port]() { (void)get(port, "/slow"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+    server.stop(std::chrono::milliseconds { 0 });
+  }
+
+  if (server.port(0).start() < 0) {
+    return strerror(errno);
+  }
+
+  const std::string body { get(server.port(), "/slow", std::chrono::milliseconds { 500 }) };
+  server.stop(std::chrono::milliseconds { 0 });
+  return std::format("after restart: {}", body.empty() ? "no answer" : body);
+}
+
+[[nodiscard]]
+static bool blocked(const int signo) {
+  sigset_t set {};
+  pthread_sigmask(SIG_BLOCK, nullptr, &set);
+  return sigismember(&set, signo) == 1;
+}
+
+/* run() with signal handling blocks SIGTERM only while it runs */
+static std::string mask() {
+  const http::Router router { named("mask") };
+  http::Server server(router, 1);
+  server.addrs("127.0.0.1").port(0).handle_signals(true);
+
+  std::string res {};
+  std::jthread runner([&server, &res]() {
+    /* threads of pool workers start with the signal blocked */
+    sigset_t set {};
+    sigemptyset(&set);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+
+    const bool before { blocked(SIGTERM) };
+    const int ret { server.run() };
+    res = std::format("before {}, after {} | {}", before ? "blocked" : "unblocked", blocked(SIGTERM) ? "blocked" : "unblocked", ret);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+  server.stop();
+  runner.join();
+  return res;
+}
+
+int main() {
+  http::Router router;
+  router.add("/ephemeral", http::Method::Get, [](const http::Request&) {
+    return http::Response(ephemeral());
+  });
+
+  router.add("/restart", http::Method::Get, [](const http::Request&) {
+    return http::Response(restart());
+  });
+
+  router.add("/pair", http::Method::Get, [](const http::Request&) {
+    return http::Response(pair());
+  });
+
+  router.add("/mask", http::Method::Get, [](const http::Request&) {
+    return http::Response(mask());
+  });
+
+  router.add("/refill", http::Method::Get, [](const http::Request&) {
+    return http::Response(refill());
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
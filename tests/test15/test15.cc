@@ -0,0 +1,126 @@
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <poll.h>
+#include <unistd.h>
+#include <lime.h>
+
+namespace http = lime::http;
+using namespace std::chrono_literals;
+
+/* opens a connection to a port on the loopback, -1 on failure */
+static int connect_to(const uint16_t port) {
+  const int fd { socket(AF_INET, SOCK_STREAM, 0) };
+  sockaddr_in addr {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void send_all(const int fd, std::string_view data) {
+  (void)write(fd, data.data(), data.size());
+}
+
+/* reads whatever arrives next, "eof" once the server closed and "nothing" when it stays silent */
+static std::string receive(const int fd, const std::chrono::milliseconds& wait) {
+  pollfd pfd { .fd = fd, .events = POLLIN, .revents = 0 };
+  if (poll(&pfd, 1, static_cast<int>(wait.count())) <= 0) {
+    return "nothing";
+  }
+
+  char buffer[1024];
+  const ssize_t n { read(fd, buffer, sizeof(buffer)) };
+  if (n <= 0) {
+    return "eof";
+  }
+
+  /* only the status line */
+  const std::string_view res { buffer, static_cast<size_t>(n) };
+  return std::string { res.substr(0, res.find('\n')) };
+}
+
+/* whether an event came about when a 300ms timeout should fire */
+static std::string after(const std::chrono::steady_clock::time_point& start) {
+  const auto elapsed { std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start) };
+  return elapsed < 150ms ? "too early" : elapsed < 1500ms ? "in time" : "too late";
+}
+
+/*
+* runs a scenario against a server with short timeouts, the client sends
+* what is given and reports what it received and when
+*/
+static std::string scenario(const http::Timeouts& timeouts, std::string_view first, const bool idle) {
+  http::Router router;
+  router.add("/", http::Method::Post, [](const http::Request& req) {
+    return http::Response(req.body);
+  });
+  router.add("/", http::Method::Get, [](const http::Request&) {
+    return http::Response("hello");
+  });
+
+  http::Server server(router, 1);
+  if (server.addrs("127.0.0.1").port(0).timeouts(timeouts).start() < 0) {
+    return strerror(errno);
+  }
+
+  const int fd { connect_to(server.port()) };
+  send_all(fd, first);
+
+  std::string res {};
+  if (idle) {
+    /* the answer to a complete request first, then the idle connection is closed */
+    res = receive(fd, 1s) + " | ";
+  }
+
+  const auto start { std::chrono::steady_clock::now() };
+  const std::string got { receive(fd, 3s) };
+  res += got == "nothing" ? got : std::format("{} {}", got, after(start));
+  close(fd);
+  return res;
+}
+
+int main() {
+  const http::Timeouts timeouts {
+    .header_read = 300ms,
+    .body_read = 300ms,
+    .write = 300ms,
+    .keep_alive = 300ms,
+    .drain = 300ms,
+  };
+
+  http::Router router;
+
+  /* the headers never end */
+  router.add("/header", http::Method::Get, [&timeouts](const http::Request&) {
+    return http::Response(scenario(timeouts, "GET / HTTP/1.1\r\nHost: local", false));
+  });
+
+  /* the body stops short of its Content-Length */
+  router.add("/body", http::Method::Get, [&timeouts](const http::Request&) {
+    return http::Response(scenario(timeouts, "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 10\r\n\r\nabc", false));
+  });
+
+  /* no next request on a kept alive connection */
+  router.add("/idle", http::Method::Get, [&timeouts](const http::Request&) {
+    return http::Response(scenario(timeouts, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n", true));
+  });
+
+  /* zero disables every timeout, the stalled request is left alone */
+  router.add("/disabled", http::Method::Get, [](const http::Request&) {
+    return http::Response(scenario({ 0ms, 0ms, 0ms, 0ms, 0ms }, "GET / HTTP/1.1\r\nHost: local", false));
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
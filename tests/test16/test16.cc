@@ -0,0 +1,31 @@
+#include <cstring>
+#include <lime.h>
+
+int main() {
+  namespace http = lime::http;
+
+  http::Router router;
+  router.add("/", http::Method::Get, [](const http::Request&) {
+    return http::Response("hello");
+  });
+
+  router.add("/", http::Method::Post, [](const http::Request& req) {
+    return http::Response(req.body);
+  });
+
+  /* small enough for curl to cross each one */
+  const http::Limits limits {
+    .uri_length = 32,
+    .header_bytes = 256,
+    .header_count = 5,
+    .body_bytes = 16,
+  };
+
+  http::Server server(router);
+  if(server.port(8080).limits(limits).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+#include <cstring>
+#include <lime.h>
+
+struct Pair {
+  int64_t a;
+  int64_t b;
+};
+LIME_JSON_FIELDS(Pair, a, b)
+
+int main() {
+  namespace http = lime::http;
+  namespace json = lime::json;
+
+  /* the type and the encoding of a decoded body, or the error */
+  const auto describe = [](const std::expected<json::Node, std::string>& node) {
+    if (!node) {
+      return http::Response("error");
+    }
+    return http::Response(std::format("{} {}", json::to_string(node->type()), json::encode(*node)));
+  };
+
+  http::Router router;
+  router.add("/decode", http::Method::Post, [&describe](const http::Request& req) {
+    return describe(json::decode(req.body));
+  });
+
+  router.add("/document", http::Method::Post, [&describe](const http::Request& req) {
+    const auto doc { json::Document::parse(req.body) };
+    if (!doc) {
+      return describe(std::unexpected(doc.error()));
+    }
+    return describe(doc->root().to_node());
+  });
+
+  router.add("/extract", http::Method::Post, [](const http::Request& req) {
+    const auto values { json::extract(req.body, { "/a" }) };
+    if (!values || !values->at(0)) {
+      return http::Response("error");
+    }
+    return http::Response(json::encode(*values->at(0)));
+  });
+
+  router.add("/bind", http::Method::Post, [](const http::Request& req) {
+    const auto pair { json::decode<Pair>(req.body) };
+    if (!pair) {
+      return http::Response(pair.error());
+    }
+    return http::Response(std::format("{} {}", pair->a, pair->b));
+  });
+
+  /* a number read by both decoders, which have to agree on it */
+  router.add("/number", http::Method::Post, [](const http::Request& req) {
+    const auto node { json::decode(req.body) };
+    const auto doc { json::Document::parse(req.body) };
+
+    const std::string decoded { node ? std::format("{} {}", json::to_string(node->type()), json::encode(*node)) : node.error() };
+    const std::string document { doc ? std::format("{} {}", json::to_string(doc->root().type()), json::encode(doc->root().to_node())) : doc.error() };
+    return http::Response(decoded == document ? decoded : std::format("decode: {}, document: {}", decoded, document));
+  });
+
+  /* fed one byte at a time, so every token is split between chunks */
+  router.add("/stream", http::Method::Post, [](const http::Request& req) {
+    json::Reader reader {};
+    std::string res {};
+    size_t pos { 0 };
+
+    while (true) {
+      const json::Event event { reader.next() };
+      switch (event) {
+        case json::Event::NeedMore:
+        if (pos < req.body.size()) {
+          reader.feed(std::string_view { req.body }.substr(pos++, 1));
+        } else {
+          reader.finish();
+        }
+        continue;
+
+        case json::Event::Key:
+        res += std::format("{}=", reader.key());
+        continue;
+
+        case json::Event::Value:
+        if (reader.type() == json::NodeType::String) {
+          res += std::format("{} ", reader.get<std::string_view>());
+        } else if (reader.type() == json::NodeType::Int) {
+          res += std::format("{} ", reader.get<int64_t>());
+        } else {
+          res += std::format("{} ", json::to_string(reader.type()));
+        }
+        continue;
+
+        case json::Event::End:
+        return http::Response(res);
+
+        case json::Event::Error:
+        return http::Response(res + reader.error());
+
+        default:
+        continue;
+      }
+    }
+  });
+
+  /* arrays nested as deep as the body says, past the limit they are refused instead of overflowing the stack */
+  router.add("/deep", http::Method::Post, [](const http::Request& req) {
+    const size_t depth { std::stoul(req.body) };
+    const std::string data { std::string(depth, '[') + std::string(depth, ']') };
+
+    const auto node { json::decode(data) };
+    const auto doc { json::Document::parse(data) };
+    return http::Response(std::format("decode: {}, document: {}", node ? "ok" : node.error(), doc ? "ok" : doc.error()));
+  });
+
+  /* members built in reverse, so insertion order differs from key order, past the linear search size */
+  router.add("/ordered", http::Method::Post, [](const http::Request& req) {
+    const size_t size { std::stoul(req.body) };
+    const auto key = [&size](size_t i) { return std::to_string(size - 1 - i); };
+
+    json::OrderedObject object {};
+    for (size_t i = 0; i < size; i++) {
+      object[key(i)] = static_cast<int64_t>(i);
+    }
+
+    const auto found = [&object, &size, &key]() {
+      size_t count { 0 };
+      for (size_t i = 0; i < size; i++) {
+        const auto it { object.find(key(i)) };
+        count += it != object.end() && std::get<int64_t>(it->second.get()) == static_cast<int64_t>(i);
+      }
+      return count;
+    };
+    const auto order = [&object]() {
+      std::string keys {};
+      for (const auto& [name, value]: object) {
+        keys += keys.empty() ? name : " " + name;
+      }
+      return keys.size() > 16 ? keys.substr(0, 8) + ".. " + (object.end() - 1)->first : keys;
+    };
+
+    std::string out { std::format("{} | found {}", order(), found()) };
+    const size_t middle { size / 2 };
+    object.erase(object.find(key(middle)));
+    out += std::format(" | erased {}: {}", key(middle), order());
+    const bool again { object.emplace(key(middle), static_cast<int64_t>(middle)).second };
+    const bool twice { object.emplace(key(middle), int64_t { -1 }).second };
+    out += std::format(" | emplaced {} {}: {} | found {}", again, twice, order(), found());
+
+    json::Object plain {};
+    plain["a"] = int64_t { 1 };
+    plain["a"] = int64_t { 2 };
+    return http::Response(std::format("{} | {}", out, json::encode(plain)));
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
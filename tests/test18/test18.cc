@@ -0,0 +1,111 @@
+#include <arpa/inet.h>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <poll.h>
+#include <unistd.h>
+#include <lime.h>
+
+namespace http = lime::http;
+
+/* opens a connection to a port on the loopback, -1 on failure */
+static int connect_to(const uint16_t port) {
+  const int fd { socket(AF_INET, SOCK_STREAM, 0) };
+  sockaddr_in addr {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* everything the server sends until it closes, stops after a second of silence */
+static std::string read_all(const int fd) {
+  std::string res {};
+  char buffer[1024];
+  for (pollfd pfd { .fd = fd, .events = POLLIN, .revents = 0 }; poll(&pfd, 1, 1000) > 0;) {
+    const ssize_t n { read(fd, buffer, sizeof(buffer)) };
+    if (n <= 0) {
+      return res + "eof";
+    }
+    res.append(buffer, static_cast<size_t>(n));
+  }
+  return res + "open";
+}
+
+/* the status code and body of each response in order, then whether the server closed */
+static std::string summary(std::string_view data) {
+  std::string res {};
+  while (data.starts_with("HTTP/")) {
+    const std::string_view status { data.substr(9, 3) };
+    const size_t length { data.find("Content-Length: ") };
+    const size_t body { data.find("\r\n") };
+    if (length == std::string_view::npos || body == std::string_view::npos) {
+      break;
+    }
+
+    size_t size { 0 };
+    std::from_chars(data.data() + length + 16, data.data() + data.size(), size);
+    res += std::format("{} {} | ", status, data.substr(body + 2, size));
+    data.remove_prefix(body + 2 + size);
+  }
+  return res + std::string { data };
+}
+
+/* sends the bytes to a fresh server on one connection */
+static std::string exchange(std::string_view request) {
+  http::Router router;
+  router.add("/echo", http::Method::Post, [](const http::Request& req) {
+    return http::Response(req.body);
+  });
+  router.add("/echo", http::Method::Get, [](const http::Request&) {
+    return http::Response("get");
+  });
+
+  http::Server server(router, 1);
+  if (server.addrs("127.0.0.1").port(0).start() < 0) {
+    return strerror(errno);
+  }
+
+  const int fd { connect_to(server.port()) };
+  (void)write(fd, request.data(), request.size());
+  const std::string res { summary(read_all(fd)) };
+  close(fd);
+  server.stop(std::chrono::milliseconds { 0 });
+  return res;
+}
+
+int main() {
+  http::Router router;
+
+  /* header names are matched ignoring case, the body is not read as the next request */
+  router.add("/pipeline", http::Method::Get, [](const http::Request&) {
+    return http::Response(exchange(
+      "POST /echo HTTP/1.1\r\nHost: localhost\r\ncontent-length: 5\r\n\r\nhello"
+      "GET /echo HTTP/1.1\r\nHost: localhost\r\nconnection: close\r\n\r\n"
+    ));
+  });
+
+  router.add("/conflict", http::Method::Get, [](const http::Request&) {
+    return http::Response(exchange(
+      "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\ncontent-length: 6\r\n\r\nhello!"
+    ));
+  });
+
+  router.add("/repeat", http::Method::Get, [](const http::Request&) {
+    return http::Response(exchange(
+      "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\nCONTENT-LENGTH: 5\r\nConnection: close\r\n\r\nhello"
+    ));
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,32 @@
+#include <chrono>
+#include <cstring>
+#include <lime.h>
+
+int main() {
+  namespace http = lime::http;
+
+  http::Router router;
+  router.add("/sleep", http::Method::Get, [](const http::Request&) -> lime::Task<http::Response> {
+    co_await lime::sleep(std::chrono::milliseconds(100));
+    co_return http::Response("woke up");
+  });
+
+  router.add("/offload", http::Method::Get, [](const http::Request& req) -> lime::Task<http::Response> {
+    const auto name = co_await lime::offload([&req]() {
+      return req.params.contains("name") ? req.params.at("name") : std::string("buddy");
+    });
+    co_return http::Response(std::format("Hi! {}", name));
+  });
+
+  router.add("/sync", http::Method::Get, [](const http::Request&) {
+    return http::Response("still works");
+  });
+
+  http::Server server(router);
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+#include <cstdint>
+#include <lime.h>
+#include <cstring>
+
+namespace http = lime::http;
+namespace json = lime::json;
+
+static http::Response invalid() {
+  return http::Response(
+    json::encode(json::Object{{"msg", "invalid order"}}),
+    http::StatusCode::BadRequest
+  );
+}
+
+static http::Response order(const http::Request& req) {
+  // the document references req.body instead of copying it
+  const auto doc = json::Document::parse(req.body);
+  if(!doc.has_value()) {
+    return invalid();
+  }
+
+  const auto root = doc->root();
+  const auto items = root.find("items");
+  if(root.type() != json::NodeType::Object || !items || items->type() != json::NodeType::Array) {
+    return invalid();
+  }
+
+  int64_t qty = 0;
+  json::Array skus;
+  for(const auto item: items->elements()) {
+    const auto sku = item.find("sku");
+    const auto count = item.find("qty");
+    if(!sku || !count || sku->type() != json::NodeType::String || count->type() != json::NodeType::Int) {
+      return invalid();
+    }
+
+    qty += count->get<int64_t>();
+    skus.emplace_back(std::string(sku->get<std::string_view>()));
+  }
+
+  return json::encode(json::Object{{"qty", qty}, {"skus", skus}});
+}
+
+static http::Response count(const http::Request& req) {
+  // feed the body in small chunks like it would arrive from a socket
+  json::Reader reader;
+  std::string_view body = req.body;
+  int64_t records = 0, qty = 0;
+  bool is_qty = false;
+
+  while(true) {
+    const auto event = reader.next();
+    if(event == json::Event::End) {
+      break;
+    }
+
+    switch(event) {
+      case json::Event::NeedMore:
+      if(body.empty()) {
+        reader.finish();
+      } else {
+        reader.feed(body.substr(0, 3));
+        body.remove_prefix(std::min<size_t>(3, body.size()));
+      }
+      break;
+
+      case json::Event::StartObject:
+      if(reader.depth() == 2) {
+        records++;
+      }
+      break;
+
+      case json::Event::Key:
+      // keys are only valid until the next feed, compare them right away
+      is_qty = reader.key() == "qty";
+      break;
+
+      case json::Event::Value:
+      if(is_qty && reader.type() == json::NodeType::Int) {
+        qty += reader.get<int64_t>();
+      }
+      break;
+
+      case json::Event::Error:
+      return invalid();
+
+      default:
+      break;
+    }
+  }
+
+  return json::encode(json::Object{{"records", records}, {"qty", qty}});
+}
+
+struct Item {
+  std::string sku;
+  int32_t qty;
+  std::optional<double> price;
+};
+LIME_JSON_FIELDS(Item, sku, qty, price)
+
+struct Order {
+  std::string customer;
+  std::vector<Item> items;
+};
+LIME_JSON_FIELDS(Order, customer, items)
+
+struct Invoice {
+  std::string customer;
+  int64_t qty;
+  double total;
+};
+LIME_JSON_FIELDS(Invoice, customer, qty, total)
+
+static http::Response invoice(const http::Request& req) {
+  // parsed straight into the structs, the error names the offending value
+  const auto order = json::decode<Order>(req.body);
+  if(!order.has_value()) {
+    return http::Response(
+      json::encode(json::Object{{"msg", order.error()}}),
+      http::StatusCode::BadRequest
+    );
+  }
+
+  Invoice res { order->customer, 0, 0 };
+  for(const auto& item: order->items) {
+    res.qty += item.qty;
+    res.total += item.qty * item.price.value_or(1);
+  }
+
+  return json::encode(res);
+}
+
+static http::Response peek(const http::Request& req) {
+  // only the two values are parsed, the rest of the body is skipped
+  const auto values = json::extract(req.body, {"/customer", "/items/1/sku"});
+  if(!values.has_value()) {
+    return invalid();
+  }
+
+  json::Object res;
+  if(const auto& customer = values->at(0); customer.has_value()) {
+    res.insert({"customer", *customer});
+  }
+
+  if(const auto& sku = values->at(1); sku.has_value()) {
+    res.insert({"second", *sku});
+  }
+
+  return json::encode(res);
+}
+
+static http::Response catalog(const http::Request&) {
+  // written straight into the body without building nodes
+  std::string body;
+  json::Writer writer(body);
+
+  writer.begin_array();
+  for(int i = 1; i <= 3; i++) {
+    writer.begin_object()
+      .key("sku").value(std::format("s{}", i))
+      .key("price").value(i * 1.5)
+      .key("stock").value(i % 2 == 1)
+      .end_object();
+  }
+  writer.end_array();
+
+  return http::Response(std::move(body));
+}
+
+int main() {
+  http::Router router;
+  router.add("/order", http::Method::Post, order);
+  router.add("/count", http::Method::Post, count);
+  router.add("/catalog", http::Method::Get, catalog);
+  router.add("/invoice", http::Method::Post, invoice);
+  router.add("/peek", http::Method::Post, peek);
+
+  http::Server server(router);
+
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <lime.h>
+
+static constexpr auto LogPath { "/tmp/lime_test8_access.log" };
+
+int main() {
+  namespace http = lime::http;
+  namespace json = lime::json;
+
+  std::filesystem::remove(LogPath);
+  if (!lime::access_logfile(LogPath)) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  http::Router router;
+  router.add("/fast", http::Method::Get, [](const http::Request&) {
+    return http::Response("fast");
+  });
+
+  router.add("/slow", http::Method::Post, [](const http::Request&) -> lime::Task<http::Response> {
+    co_await lime::sleep(std::chrono::milliseconds(100));
+    co_return http::Response("slow", http::StatusCode::Created);
+  });
+
+  /* the fields of the records written so far which do not change between runs */
+  router.add("/log", http::Method::Get, [](const http::Request&) {
+    lime::flush_logs();
+
+    std::ifstream file { LogPath };
+    std::string body {};
+    json::Writer writer { body };
+    writer.begin_array();
+
+    for (std::string line; std::getline(file, line);) {
+      const auto values { json::extract(line, { "/method", "/path", "/status", "/latency_us" }) };
+      if (!values || !(*values)[3]) {
+        return http::Response("invalid record", http::StatusCode::InternalServerError);
+      }
+
+      writer.begin_object()
+        .key("method").value(*(*values)[0])
+        .key("path").value(*(*values)[1])
+        .key("status").value(*(*values)[2])
+        .key("slow").value((*values)[3]->get<int64_t>() >= 50000)
+        .end_object();
+    }
+
+    writer.end_array();
+    return http::Response(std::move(body));
+  });
+
+  /* nothing is sampled, only requests slower than 50ms are logged */
+  http::Server server(router);
+  server.access_log({
+    .enabled = true,
+    .format = http::AccessLog::Format::Json,
+    .sample = 0.0,
+    .slow = std::chrono::milliseconds(50),
+  });
+
+  if(server.port(8080).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
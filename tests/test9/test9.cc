@@ -0,0 +1,42 @@
+#include <cstring>
+#include <sstream>
+#include <lime.h>
+
+int main() {
+  namespace http = lime::http;
+  namespace metrics = lime::metrics;
+
+  auto& greetings { metrics::registry().counter("app_greetings_total", "Greetings sent") };
+
+  http::Router router;
+  router.add("/hello", http::Method::Get, [&greetings](const http::Request&) {
+    greetings.add();
+    return http::Response("hello");
+  });
+
+  /* the lines of the exposition which do not change between runs, scrapes of the admin port are not counted */
+  router.add("/check", http::Method::Get, [](const http::Request&) {
+    std::istringstream exposition { metrics::prometheus(metrics::registry()) };
+    std::string res {};
+
+    for (std::string line; std::getline(exposition, line);) {
+      if (line.starts_with("app_greetings_total")
+        || line.starts_with("lime_requests_total{route=\"/hello\",method=\"GET\",code=\"2xx\"}")
+        || line.starts_with("lime_handler_seconds_count")
+        || line.starts_with("lime_connections_accepted_total")
+        || line.starts_with("lime_requests_total{route=\"/metrics\"")
+        || line.starts_with("# TYPE lime_handler_seconds")) {
+        res += res.empty() ? line : " | " + line;
+      }
+    }
+    return http::Response(res);
+  });
+
+  http::Server server(router);
+  if(server.port(8080).admin_port(9100).run() < 0) {
+    std::perror(std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}